@@ -0,0 +1,214 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "Counters.h"
+#include "DiagnosticFormatter.h"
+#include "JsonWriter.h"
+
+#include <hayai/hayai.hpp>
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libpass/PassManager>
+#include <libpass/PassResult>
+#include <libpass/analyze/LoadFilePass>
+#include <libstdhl/Log>
+#include <libstdhl/data/file/TextDocument>
+#include <libstdhl/net/lsp/LSP>
+
+#include <iostream>
+
+using namespace libstdhl::Network::LSP;
+
+static constexpr std::size_t PAYLOAD_SIZE = 1024 * 1024;
+static constexpr std::size_t DIAGNOSTICS = 2000;
+
+/**
+   'textDocument/didChange' notification with a text of 'PAYLOAD_SIZE' bytes
+*/
+static const std::string& largePayload( void )
+{
+    static std::string payload = "";
+    if( not payload.empty() )
+    {
+        return payload;
+    }
+
+    std::string text = "";
+    for( std::size_t rule = 0; text.size() < PAYLOAD_SIZE; rule++ )
+    {
+        text += "rule rule_" + std::to_string( rule ) + " =\n{\n    counter := counter + " +
+                std::to_string( rule ) + " // \"quoted\" comment\n}\n\n";
+    }
+
+    casmd::JsonWriter json( payload );
+    json.beginObject();
+    json.key( "jsonrpc" ).string( "2.0", 3 );
+    json.key( "method" ).string( "textDocument/didChange" );
+    json.key( "params" ).beginObject();
+    json.key( "textDocument" ).beginObject();
+    json.key( "uri" ).string( "inmemory://benchmark.casm" );
+    json.key( "version" ).number( 2 );
+    json.endObject();
+    json.key( "contentChanges" ).beginArray().beginObject();
+    json.key( "text" ).string( text );
+    json.endObject().endArray();
+    json.endObject();
+    json.endObject();
+    return payload;
+}
+
+namespace
+{
+    /**
+       keeps the log items of a stream instead of writing them
+    */
+    class RecordingSink final : public libstdhl::Log::Sink
+    {
+      public:
+        RecordingSink( libstdhl::Log::Formatter& formatter )
+        : libstdhl::Log::Sink( formatter )
+        {
+        }
+
+        void process( libstdhl::Log::Data& data ) override
+        {
+            items.emplace_back( data );
+        }
+
+        std::vector< libstdhl::Log::Data > items;
+    };
+}
+
+/**
+   located log items of an analysis which reports 'DIAGNOSTICS' errors
+*/
+static std::vector< libstdhl::Log::Data >& logItems( void )
+{
+    static std::vector< libstdhl::Log::Data > items;
+    if( not items.empty() )
+    {
+        return items;
+    }
+
+    std::string text = "CASM\n\ninit rule_0\n\n";
+    for( std::size_t rule = 0; rule < DIAGNOSTICS; rule++ )
+    {
+        text += "rule rule_" + std::to_string( rule ) + " =\n{\n    undefined_" +
+                std::to_string( rule ) + " := " + std::to_string( rule ) + "\n}\n\n";
+    }
+
+    libstdhl::File::TextDocument file( DocumentUri::fromString( "inmemory://log.casm" ), "casm" );
+    file.setData( text );
+
+    libpass::PassResult pr;
+    pr.setOutput< libpass::LoadFilePass >( file );
+
+    libpass::PassManager pm;
+    pm.setDefaultResult( pr );
+    pm.setDefaultPass< libcasm_fe::ConsistencyCheckPass >();
+    pm.run();
+
+    casmd::DiagnosticFormatter formatter( "casmd" );
+    RecordingSink sink( formatter );
+    pm.stream().flush( sink );
+
+    items = std::move( sink.items );
+    return items;
+}
+
+class CounterBenchmark : public ::hayai::Fixture
+{
+  public:
+    CounterBenchmark( void )
+    : header( "Content-Length: " + std::to_string( largePayload().size() ) + "\r\n\r\n" )
+    , payload( largePayload() )
+    , message( Message::parse( payload ) )
+    , items( logItems() )
+    , iterations( 0 )
+    , result( 0 )
+    {
+    }
+
+    void SetUp( void ) override
+    {
+        iterations = 0;
+        counters.start();
+    }
+
+    void TearDown( void ) override
+    {
+        counters.stop();
+        counters.report( std::cout, iterations );
+    }
+
+    const std::string header;
+    const std::string& payload;
+    const Message message;
+    std::vector< libstdhl::Log::Data >& items;
+    Counters counters;
+    libstdhl::u64 iterations;
+
+    // consumed results, the measured calls are not optimized away
+    volatile std::size_t result;
+};
+
+BENCHMARK_F( CounterBenchmark, protocol_parse, 10, 10000 )
+{
+    iterations++;
+    result = Protocol::parse( header ).length();
+}
+
+BENCHMARK_F( CounterBenchmark, message_parse, 10, 10 )
+{
+    iterations++;
+    result = Message::parse( payload ).size();
+}
+
+BENCHMARK_F( CounterBenchmark, diagnostic_formatter, 10, 10 )
+{
+    iterations++;
+    casmd::DiagnosticFormatter formatter( "casmd" );
+    for( auto& item : items )
+    {
+        result = formatter.visit( item ).size();
+    }
+    result = formatter.diagnostics().size();
+}
+
+BENCHMARK_F( CounterBenchmark, packet_dump, 10, 10 )
+{
+    iterations++;
+    const Packet packet( Protocol( payload.size() ), message );
+    result = packet.dump( false ).size();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
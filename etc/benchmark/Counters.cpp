@@ -0,0 +1,209 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "Counters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined( __linux__ )
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace libstdhl;
+
+static const char* EVENT_NAMES[] = { "cycles", "instructions", "cache misses" };
+
+// heap allocations of the benchmark binary, its allocation functions only
+// count and forward to 'malloc'
+static std::atomic< std::size_t > s_allocations{ 0 };
+
+void* operator new( std::size_t size )
+{
+    s_allocations.fetch_add( 1, std::memory_order_relaxed );
+    if( auto pointer = std::malloc( size ? size : 1 ) )
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    std::free( pointer );
+}
+
+static std::size_t allocations( void )
+{
+    return s_allocations.load( std::memory_order_relaxed );
+}
+
+#if defined( __linux__ )
+
+static int openCounter( const u64 config )
+{
+    perf_event_attr attribute;
+    std::memset( &attribute, 0, sizeof( attribute ) );
+    attribute.type = PERF_TYPE_HARDWARE;
+    attribute.size = sizeof( attribute );
+    attribute.config = config;
+    attribute.disabled = 1;
+    attribute.exclude_kernel = 1;
+    attribute.exclude_hv = 1;
+
+    return static_cast< int >( ::syscall( __NR_perf_event_open, &attribute, 0, -1, -1, 0 ) );
+}
+
+#endif
+
+Counters::Counters( void )
+: m_descriptors()
+, m_values()
+, m_allocations( 0 )
+, m_unavailable()
+{
+#if defined( __linux__ )
+    const u64 configs[ EVENTS ] = { PERF_COUNT_HW_CPU_CYCLES,
+                                    PERF_COUNT_HW_INSTRUCTIONS,
+                                    PERF_COUNT_HW_CACHE_MISSES };
+
+    for( std::size_t event = 0; event < EVENTS; event++ )
+    {
+        m_descriptors[ event ] = openCounter( configs[ event ] );
+        if( m_descriptors[ event ] < 0 and m_unavailable.empty() )
+        {
+            m_unavailable = std::strerror( errno );
+        }
+    }
+#else
+    for( auto& descriptor : m_descriptors )
+    {
+        descriptor = -1;
+    }
+    m_unavailable = "unsupported platform";
+#endif
+}
+
+Counters::~Counters( void )
+{
+#if defined( __linux__ )
+    for( const auto descriptor : m_descriptors )
+    {
+        if( descriptor >= 0 )
+        {
+            ::close( descriptor );
+        }
+    }
+#endif
+}
+
+void Counters::start( void )
+{
+    m_allocations = allocations();
+
+#if defined( __linux__ )
+    for( const auto descriptor : m_descriptors )
+    {
+        if( descriptor >= 0 )
+        {
+            ::ioctl( descriptor, PERF_EVENT_IOC_RESET, 0 );
+            ::ioctl( descriptor, PERF_EVENT_IOC_ENABLE, 0 );
+        }
+    }
+#endif
+}
+
+void Counters::stop( void )
+{
+#if defined( __linux__ )
+    for( std::size_t event = 0; event < EVENTS; event++ )
+    {
+        const auto descriptor = m_descriptors[ event ];
+        m_values[ event ] = 0;
+        if( descriptor >= 0 )
+        {
+            ::ioctl( descriptor, PERF_EVENT_IOC_DISABLE, 0 );
+            if( ::read( descriptor, &m_values[ event ], sizeof( u64 ) ) != sizeof( u64 ) )
+            {
+                m_values[ event ] = 0;
+            }
+        }
+    }
+#endif
+
+    m_allocations = allocations() - m_allocations;
+}
+
+void Counters::report( std::ostream& stream, const u64 iterations ) const
+{
+    const auto count = iterations > 0 ? iterations : 1;
+    char buffer[ 64 ];
+
+    stream << "        per iteration:";
+    for( std::size_t event = 0; event < EVENTS; event++ )
+    {
+        if( m_descriptors[ event ] < 0 )
+        {
+            stream << " " << EVENT_NAMES[ event ] << " n/a,";
+            continue;
+        }
+
+        std::snprintf(
+            buffer,
+            sizeof( buffer ),
+            " %s %.1f,",
+            EVENT_NAMES[ event ],
+            static_cast< double >( m_values[ event ] ) / count );
+        stream << buffer;
+    }
+
+    std::snprintf(
+        buffer,
+        sizeof( buffer ),
+        " allocations %.1f\n",
+        static_cast< double >( m_allocations ) / count );
+    stream << buffer;
+
+    if( not m_unavailable.empty() )
+    {
+        stream << "        hardware counters unavailable: " << m_unavailable << "\n";
+    }
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,89 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_BENCHMARK_COUNTERS_H_
+#define _CASMD_BENCHMARK_COUNTERS_H_
+
+/**
+   @brief    hardware counters and allocation counts of a benchmark run
+
+   The cycles, instructions and cache misses of the calling thread are
+   read with 'perf_event_open', the allocations are counted by the global
+   allocation functions of the benchmark binary.  A counter which can not be
+   opened (e.g. in a container without access to the performance
+   monitoring unit or on another platform) is reported as unavailable and
+   the other values are still measured.
+*/
+
+#include <libstdhl/Type>
+
+#include <ostream>
+#include <string>
+
+class Counters
+{
+  public:
+    Counters( void );
+
+    ~Counters( void );
+
+    Counters( const Counters& ) = delete;
+
+    Counters& operator=( const Counters& ) = delete;
+
+    void start( void );
+
+    void stop( void );
+
+    /**
+       writes the counted values divided by 'iterations'
+    */
+    void report( std::ostream& stream, const libstdhl::u64 iterations ) const;
+
+  private:
+    enum Event
+    {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        EVENTS
+    };
+
+    int m_descriptors[ EVENTS ];
+    libstdhl::u64 m_values[ EVENTS ];
+    std::size_t m_allocations;
+    std::string m_unavailable;
+};
+
+#endif  // _CASMD_BENCHMARK_COUNTERS_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
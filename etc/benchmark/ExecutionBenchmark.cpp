@@ -0,0 +1,121 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "Execution.h"
+
+#include <hayai/hayai.hpp>
+
+#include <libstdhl/data/file/TextDocument>
+#include <libstdhl/net/lsp/LSP>
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace libstdhl::Network::LSP;
+
+static constexpr std::size_t STEPS = 100;
+static constexpr std::size_t CELLS = 8192;
+
+/**
+   counter loop with a forall over a function table and a derived call in
+   every step, the forall is large enough for the parallel evaluation
+*/
+static std::string specification( void )
+{
+    std::string text = "CASM\n\ninit main\n\n";
+    text += "function counter : -> Integer = { 0 }\n";
+    text += "function cells : Integer -> Integer\n\n";
+    text += "derived square( x : Integer ) -> Integer = x * x\n\n";
+    text += "rule main =\n{\n";
+    text += "    forall i in [ 0 .. " + std::to_string( CELLS - 1 ) + " ] do\n";
+    text += "        cells( i ) := square( i ) + counter\n";
+    text += "    counter := counter + 1\n";
+    text += "    if counter = " + std::to_string( STEPS ) + " then\n";
+    text += "    {\n";
+    text += "        println( \"counter = \" + ( counter as String ) )\n";
+    text += "        program( self ) := undef\n";
+    text += "    }\n";
+    text += "}\n";
+    return text;
+}
+
+class ExecutionBenchmark : public ::hayai::Fixture
+{
+  public:
+    ExecutionBenchmark( void )
+    : file( DocumentUri::fromString( "inmemory://benchmark.casm" ), "casm" )
+    {
+        file.setData( specification() );
+
+        // all backends have to yield the same output
+        const auto output = execute( casmd::Execution::Backend::AST );
+        if( execute( casmd::Execution::Backend::FLAT ) != output or
+            execute( casmd::Execution::Backend::PARALLEL ) != output )
+        {
+            std::cerr << "the backends yield different outputs\n";
+            std::abort();
+        }
+    }
+
+    std::string execute( const casmd::Execution::Backend backend )
+    {
+        std::ostringstream log;
+        casmd::Execution execution( file );
+        execution.setBackend( backend );
+        execution.run( log );
+        if( not execution.fallback().empty() )
+        {
+            std::cerr << "flat backend fell back: " << execution.fallback() << "\n";
+        }
+        return execution.output();
+    }
+
+    libstdhl::File::TextDocument file;
+};
+
+BENCHMARK_F( ExecutionBenchmark, run_ast, 3, 3 )
+{
+    execute( casmd::Execution::Backend::AST );
+}
+
+BENCHMARK_F( ExecutionBenchmark, run_flat, 3, 3 )
+{
+    execute( casmd::Execution::Backend::FLAT );
+}
+
+BENCHMARK_F( ExecutionBenchmark, run_parallel, 3, 3 )
+{
+    execute( casmd::Execution::Backend::PARALLEL );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
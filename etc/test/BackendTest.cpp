@@ -0,0 +1,161 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "main.h"
+
+#include "Batch.h"
+#include "Execution.h"
+#include "Interface.h"
+#include "JsonWriter.h"
+
+#include <libstdhl/data/file/TextDocument>
+#include <libstdhl/net/lsp/LSP>
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+   Differential test of the execution backends: every deterministic
+   libcasm-tc specification is executed by the AST interpreter and by the
+   flat backend, sequentially and in parallel.  The output, the diagnostics
+   and the success of the executions have to be the same, regardless of
+   whether the flat backend executed the specification or fell back to the
+   AST interpreter.  The amount of specifications each backend actually
+   executed and the reasons of the fallbacks are reported on stderr and as
+   test properties, a passing comparison of fallbacks only proves nothing
+   about the flat backend.
+
+   The specifications are taken from the directory CASMD_BACKEND_SPECS.
+*/
+
+#ifndef CASMD_BACKEND_SPECS
+#define CASMD_BACKEND_SPECS "lib/casm-tc"
+#endif
+
+// workers of the parallel backend, also on a machine with a single core
+static constexpr std::size_t PARALLEL_WORKERS = 2;
+
+static std::string serialize( const std::vector< casmd::Diagnostic >& diagnostics )
+{
+    std::string text = "";
+    casmd::JsonWriter json( text );
+    casmd::Diagnostic::serialize( json, diagnostics );
+    return text;
+}
+
+TEST( casmd_backend, numeric_specifications )
+{
+    const auto directory = std::getenv( "CASMD_BACKEND_SPECS" )
+                               ? std::getenv( "CASMD_BACKEND_SPECS" )
+                               : CASMD_BACKEND_SPECS;
+
+    std::vector< std::string > paths;
+    try
+    {
+        paths = casmd::Batch::collect( { directory } );
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << "backend: no specifications in '" << directory << "', skipping\n";
+        return;
+    }
+    ASSERT_FALSE( paths.empty() );
+
+    std::size_t compared = 0;
+    std::size_t flat = 0;
+    std::size_t parallel = 0;
+    std::map< std::string, std::size_t > fallbacks;
+
+    for( const auto& path : paths )
+    {
+        const auto uri = "file://" + path;
+        const auto text = casmd::Batch::read( path );
+
+        // a nondeterministic specification has no reference output
+        if( not casmd::Interface::scan( text, uri ).deterministic() )
+        {
+            continue;
+        }
+
+        libstdhl::File::TextDocument file(
+            libstdhl::Network::LSP::DocumentUri::fromString( uri ), "casm" );
+        file.setData( text );
+
+        std::ostringstream log;
+        casmd::Execution reference( file );
+        reference.run( log );
+
+        for( const auto backend :
+             { casmd::Execution::Backend::FLAT, casmd::Execution::Backend::PARALLEL } )
+        {
+            casmd::Execution execution( file );
+            execution.setBackend( backend );
+            execution.setWorkers( PARALLEL_WORKERS );
+            execution.run( log );
+
+            const auto name = backend == casmd::Execution::Backend::FLAT ? "flat" : "parallel";
+            EXPECT_EQ( execution.output(), reference.output() ) << path << " (" << name << ")";
+            EXPECT_EQ( serialize( execution.diagnostics() ), serialize( reference.diagnostics() ) )
+                << path << " (" << name << ")";
+            EXPECT_EQ( execution.success(), reference.success() ) << path << " (" << name << ")";
+
+            if( execution.backend() == casmd::Execution::Backend::AST )
+            {
+                const auto& reason = execution.fallback();
+                fallbacks[ reason.empty() ? "no flat program" : reason ]++;
+            }
+            else
+            {
+                ( backend == casmd::Execution::Backend::FLAT ? flat : parallel )++;
+            }
+        }
+
+        compared++;
+    }
+
+    std::cerr << "backend: " << compared << " specifications compared, " << flat
+              << " executed by the flat backend, " << parallel
+              << " executed by the parallel backend\n";
+    for( const auto& fallback : fallbacks )
+    {
+        std::cerr << "backend: " << fallback.second << " fallbacks, " << fallback.first << "\n";
+    }
+
+    RecordProperty( "compared", static_cast< int >( compared ) );
+    RecordProperty( "flat", static_cast< int >( flat ) );
+    RecordProperty( "parallel", static_cast< int >( parallel ) );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
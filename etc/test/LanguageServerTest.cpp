@@ -0,0 +1,248 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "main.h"
+
+#include "JsonWriter.h"
+#include "LanguageServer.h"
+
+#include <libpass/PassManager>
+
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+   Request tests of the language server: the requests are driven through the
+   same dispatch path as the 'lsp' mode and the payloads of the outbound
+   frames are checked.
+*/
+
+using libstdhl::Network::LSP::Data;
+using libstdhl::Network::LSP::DocumentUri;
+
+namespace
+{
+    class Client
+    {
+      public:
+        Client( void )
+        : m_pm()
+        , m_log( m_pm.stream() )
+        , m_server( m_log )
+        , m_id( 0 )
+        {
+        }
+
+        /**
+           sends a request or notification, 'params' writes the parameters,
+           returns the payloads of the outbound frames
+        */
+        std::vector< Data > send(
+            const char* method,
+            const std::function< void( casmd::JsonWriter& ) >& params,
+            const libstdhl::u1 notification = false )
+        {
+            std::string text = "";
+            casmd::JsonWriter json( text );
+            json.beginObject();
+            json.key( "jsonrpc" ).string( "2.0", 3 );
+            if( not notification )
+            {
+                json.key( "id" ).number( ++m_id );
+            }
+            json.key( "method" ).string( method );
+            json.key( "params" );
+            params( json );
+            json.endObject();
+
+            const auto payload = libstdhl::Network::LSP::Message::parse( text );
+            libstdhl::Network::LSP::Packet request(
+                libstdhl::Network::LSP::Protocol( text.size() ), payload );
+            if( not m_server.dispatch( payload ) )
+            {
+                request.process( m_server );
+            }
+
+            std::vector< Data > frames;
+            m_server.drain( [&]( const casmd::Frame& frame ) {
+                frames.emplace_back( Data::parse( frame.payload() ) );
+            } );
+            return frames;
+        }
+
+        /**
+           result of the response to the last request
+        */
+        Data result( const std::vector< Data >& frames ) const
+        {
+            for( const auto& frame : frames )
+            {
+                if( frame.find( "id" ) != frame.end() and frame[ "id" ] == m_id )
+                {
+                    EXPECT_EQ( frame.find( "error" ), frame.end() ) << frame.dump();
+                    return frame[ "result" ];
+                }
+            }
+
+            ADD_FAILURE() << "no response to request " << m_id;
+            return Data();
+        }
+
+        void open( const std::string& uri, const std::string& text )
+        {
+            send(
+                "textDocument/didOpen",
+                [&]( casmd::JsonWriter& json ) {
+                    json.beginObject();
+                    json.key( "textDocument" ).beginObject();
+                    json.key( "uri" ).string( uri );
+                    json.key( "languageId" ).string( "casm", 4 );
+                    json.key( "version" ).number( 1 );
+                    json.key( "text" ).string( text );
+                    json.endObject();
+                    json.endObject();
+                },
+                true );
+        }
+
+      private:
+        libpass::PassManager m_pm;
+        libstdhl::Logger m_log;
+        casmd::LanguageServer m_server;
+        casmd::i64 m_id;
+    };
+
+    const std::string SPECIFICATION =
+        "CASM\n"
+        "\n"
+        "init main\n"
+        "\n"
+        "function counter : -> Integer = { 0 }\n"
+        "\n"
+        "rule main =\n"
+        "{\n"
+        "    counter := counter + 1\n"
+        "    program( self ) := undef\n"
+        "}\n";
+}
+
+TEST( casmd_language_server, rename_escapes_document_uri )
+{
+    Client client;
+    const std::string uri = "file:///test/quote\"and\\backslash.casm";
+    client.open( uri, SPECIFICATION );
+
+    // 'counter' of the function definition in line 4
+    const auto rename = [&]( casmd::JsonWriter& json ) {
+        json.beginObject();
+        json.key( "textDocument" ).beginObject();
+        json.key( "uri" ).string( uri );
+        json.endObject();
+        json.key( "position" ).beginObject();
+        json.key( "line" ).number( 4 );
+        json.key( "character" ).number( 9 );
+        json.endObject();
+        json.key( "newName" ).string( "steps", 5 );
+        json.endObject();
+    };
+    const auto result = client.result( client.send( "textDocument/rename", rename ) );
+
+    ASSERT_TRUE( result.is_object() ) << result.dump();
+    const auto& changes = result[ "changes" ];
+    ASSERT_EQ( changes.size(), 1u ) << changes.dump();
+
+    const auto edits = changes.find( DocumentUri::fromString( uri ).toString() );
+    ASSERT_NE( edits, changes.end() ) << changes.dump();
+    ASSERT_GE( edits->size(), 2u );
+
+    for( const auto& edit : *edits )
+    {
+        EXPECT_EQ( edit[ "newText" ], "steps" );
+        EXPECT_EQ(
+            edit[ "range" ][ "end" ][ "character" ].get< casmd::i64 >() -
+                edit[ "range" ][ "start" ][ "character" ].get< casmd::i64 >(),
+            7 );
+    }
+}
+
+TEST( casmd_language_server, diagnostics_unchanged_after_comment_edit )
+{
+    Client client;
+    const std::string uri = "file:///test/comment.casm";
+    client.open( uri, SPECIFICATION );
+
+    const auto diagnostic = [&]( const std::string& previousResultId ) {
+        return client.result(
+            client.send( "textDocument/diagnostic", [&]( casmd::JsonWriter& json ) {
+                json.beginObject();
+                json.key( "textDocument" ).beginObject();
+                json.key( "uri" ).string( uri );
+                json.endObject();
+                if( not previousResultId.empty() )
+                {
+                    json.key( "previousResultId" ).string( previousResultId );
+                }
+                json.endObject();
+            } ) );
+    };
+
+    const auto full = diagnostic( "" );
+    ASSERT_TRUE( full.is_object() ) << full.dump();
+    EXPECT_EQ( full[ "kind" ], "full" );
+    const auto resultId = full[ "resultId" ].get< std::string >();
+
+    client.send(
+        "textDocument/didChange",
+        [&]( casmd::JsonWriter& json ) {
+            json.beginObject();
+            json.key( "textDocument" ).beginObject();
+            json.key( "uri" ).string( uri );
+            json.key( "version" ).number( 2 );
+            json.endObject();
+            json.key( "contentChanges" ).beginArray();
+            json.beginObject();
+            json.key( "text" ).string( SPECIFICATION + "\n// a comment\n" );
+            json.endObject();
+            json.endArray();
+            json.endObject();
+        },
+        true );
+
+    const auto unchanged = diagnostic( resultId );
+    ASSERT_TRUE( unchanged.is_object() ) << unchanged.dump();
+    EXPECT_EQ( unchanged[ "kind" ], "unchanged" ) << unchanged.dump();
+    EXPECT_EQ( unchanged[ "resultId" ], resultId );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,385 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "main.h"
+
+#include "Batch.h"
+#include "JsonWriter.h"
+#include "LanguageServer.h"
+
+#include <libpass/PassManager>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined( __GLIBC__ )
+#include <malloc.h>
+#endif
+
+/**
+   Soak test of the language server: a seeded random sequence of open,
+   change, close, execute and query requests on the libcasm-tc specifications
+   is driven through the same dispatch path as the 'lsp' mode.  RSS, live
+   heap allocations and the request latency are sampled per window, the
+   test fails if the memory of the last window grows beyond the warm-up
+   baseline or its p99 latency drifts beyond the threshold.
+
+   The run is configured by environment variables:
+     CASMD_SOAK_SPECS       directory of the specifications (libcasm-tc)
+     CASMD_SOAK_ITERATIONS  amount of requests (default 4000)
+     CASMD_SOAK_SEED        seed of the request sequence (default 1)
+     CASMD_SOAK_EXECUTE     '0' disables execute requests
+*/
+
+#ifndef CASMD_SOAK_SPECS
+#define CASMD_SOAK_SPECS "lib/casm-tc"
+#endif
+
+static constexpr std::size_t WINDOWS = 20;
+static constexpr std::size_t WARMUP_WINDOWS = 4;
+
+// the last window may use 50% more memory than the warm-up baseline plus a
+// constant slack for allocator fragmentation
+static constexpr double MEMORY_FACTOR = 1.5;
+static constexpr std::size_t MEMORY_SLACK = 32 * 1024 * 1024;
+
+// the p99 latency of the last window may be twice the baseline plus 5ms
+static constexpr double LATENCY_FACTOR = 2.0;
+static constexpr double LATENCY_SLACK = 5.0;
+
+// small budget, the eviction of the workspace is part of the soak
+static constexpr std::size_t WORKSPACE_BUDGET = 16 * 1024 * 1024;
+
+static constexpr std::size_t DOCUMENTS = 16;
+
+namespace
+{
+    struct Sample
+    {
+        std::size_t rss;
+        std::size_t heap;
+        double p99;
+    };
+
+    std::size_t environment( const char* name, const std::size_t fallback )
+    {
+        const auto value = std::getenv( name );
+        return value ? std::stoul( value ) : fallback;
+    }
+
+    std::size_t residentSetSize( void )
+    {
+        std::ifstream statm( "/proc/self/statm" );
+        std::size_t pages = 0;
+        std::size_t resident = 0;
+        if( not( statm >> pages >> resident ) )
+        {
+            return 0;
+        }
+        return resident * static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) );
+    }
+
+    /**
+       bytes of the live heap allocations, or zero if the C library does not
+       report them
+    */
+    std::size_t heapUsage( void )
+    {
+#if defined( __GLIBC__ ) and ( __GLIBC__ > 2 or __GLIBC_MINOR__ >= 33 )
+        return ::mallinfo2().uordblks;
+#else
+        return 0;
+#endif
+    }
+
+    double percentile( std::vector< double > values, const double rank )
+    {
+        if( values.empty() )
+        {
+            return 0.0;
+        }
+        const auto index = static_cast< std::size_t >( rank * ( values.size() - 1 ) );
+        std::nth_element( values.begin(), values.begin() + index, values.end() );
+        return values[ index ];
+    }
+
+    class Client
+    {
+      public:
+        Client( casmd::LanguageServer& server )
+        : m_server( server )
+        , m_id( 0 )
+        , m_frames( 0 )
+        {
+        }
+
+        /**
+           sends a request or notification, 'params' writes the parameters
+           and returns the latency in milliseconds
+        */
+        double send(
+            const char* method,
+            const std::function< void( casmd::JsonWriter& ) >& params,
+            const libstdhl::u1 notification = false )
+        {
+            std::string text = "";
+            casmd::JsonWriter json( text );
+            json.beginObject();
+            json.key( "jsonrpc" ).string( "2.0", 3 );
+            if( not notification )
+            {
+                json.key( "id" ).number( ++m_id );
+            }
+            json.key( "method" ).string( method );
+            json.key( "params" );
+            params( json );
+            json.endObject();
+
+            const auto start = std::chrono::steady_clock::now();
+
+            const auto payload = libstdhl::Network::LSP::Message::parse( text );
+            libstdhl::Network::LSP::Packet request(
+                libstdhl::Network::LSP::Protocol( text.size() ), payload );
+
+            try
+            {
+                if( not m_server.dispatch( payload ) )
+                {
+                    request.process( m_server );
+                }
+            }
+            catch( const std::exception& e )
+            {
+                // invalid specifications are part of the soak
+            }
+
+            m_server.drain( [&]( const casmd::Frame& ) { m_frames++; } );
+
+            const std::chrono::duration< double, std::milli > latency =
+                std::chrono::steady_clock::now() - start;
+            return latency.count();
+        }
+
+        std::size_t frames( void ) const
+        {
+            return m_frames;
+        }
+
+      private:
+        casmd::LanguageServer& m_server;
+        casmd::i64 m_id;
+        std::size_t m_frames;
+    };
+
+    void textDocument( casmd::JsonWriter& json, const std::string& uri )
+    {
+        json.key( "textDocument" ).beginObject();
+        json.key( "uri" ).string( uri );
+        json.endObject();
+    }
+}
+
+TEST( casmd_soak, language_server )
+{
+    const auto directory = std::getenv( "CASMD_SOAK_SPECS" ) ? std::getenv( "CASMD_SOAK_SPECS" )
+                                                              : CASMD_SOAK_SPECS;
+    const auto iterations = environment( "CASMD_SOAK_ITERATIONS", 4000 );
+    const auto seed = environment( "CASMD_SOAK_SEED", 1 );
+    const auto execute = environment( "CASMD_SOAK_EXECUTE", 1 ) != 0;
+
+    std::vector< std::string > specifications;
+    try
+    {
+        for( const auto& path : casmd::Batch::collect( { directory } ) )
+        {
+            specifications.emplace_back( casmd::Batch::read( path ) );
+        }
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << "soak: no specifications in '" << directory << "', skipping\n";
+        return;
+    }
+    ASSERT_FALSE( specifications.empty() );
+
+    libpass::PassManager pm;
+    libstdhl::Logger log( pm.stream() );
+    std::ostringstream discard;
+    libstdhl::Log::ApplicationFormatter formatter( "soak" );
+    libstdhl::Log::OutputStreamSink sink( discard, formatter );
+
+    casmd::LanguageServer server( log, WORKSPACE_BUDGET );
+    Client client( server );
+
+    client.send( "initialize", []( casmd::JsonWriter& json ) {
+        json.beginObject();
+        json.key( "processId" ).null();
+        json.key( "rootUri" ).null();
+        json.key( "capabilities" ).beginObject().endObject();
+        json.endObject();
+    } );
+    client.send(
+        "initialized", []( casmd::JsonWriter& json ) { json.beginObject().endObject(); }, true );
+
+    std::mt19937 random( seed );
+    std::vector< casmd::i64 > revisions( DOCUMENTS, 0 );
+    std::vector< double > latencies;
+    std::vector< Sample > samples;
+    const auto window = std::max< std::size_t >( iterations / WINDOWS, 1 );
+
+    for( std::size_t iteration = 0; iteration < iterations; iteration++ )
+    {
+        const auto slot = random() % DOCUMENTS;
+        const auto uri = slot == 0 ? std::string( "inmemory://model.casm" )
+                                   : "file:///soak/" + std::to_string( slot ) + ".casm";
+        const auto& text = specifications[ random() % specifications.size() ];
+        auto& revision = revisions[ slot ];
+        const auto operation = random() % 100;
+
+        if( revision == 0 or operation < 10 )
+        {
+            revision++;
+            latencies.push_back( client.send(
+                "textDocument/didOpen",
+                [&]( casmd::JsonWriter& json ) {
+                    json.beginObject();
+                    json.key( "textDocument" ).beginObject();
+                    json.key( "uri" ).string( uri );
+                    json.key( "languageId" ).string( "casm", 4 );
+                    json.key( "version" ).number( revision );
+                    json.key( "text" ).string( text );
+                    json.endObject();
+                    json.endObject();
+                },
+                true ) );
+        }
+        else if( operation < 40 )
+        {
+            // edits keep the specification valid most of the time
+            revision++;
+            const auto edited = random() % 4 == 0 ? text : text + "\n// edit " +
+                                                                std::to_string( revision ) + "\n";
+            latencies.push_back( client.send(
+                "textDocument/didChange",
+                [&]( casmd::JsonWriter& json ) {
+                    json.beginObject();
+                    json.key( "textDocument" ).beginObject();
+                    json.key( "uri" ).string( uri );
+                    json.key( "version" ).number( revision );
+                    json.key( "contentChanges" ).beginArray();
+                    json.beginObject();
+                    json.key( "text" ).string( edited );
+                    json.endObject();
+                    json.endArray();
+                    json.endObject();
+                    json.endObject();
+                },
+                true ) );
+        }
+        else if( operation < 45 )
+        {
+            revision = 0;
+            latencies.push_back( client.send(
+                "textDocument/didClose",
+                [&]( casmd::JsonWriter& json ) {
+                    json.beginObject();
+                    textDocument( json, uri );
+                    json.endObject();
+                },
+                true ) );
+        }
+        else if( operation < 50 and execute and slot == 0 )
+        {
+            const auto command = []( casmd::JsonWriter& json ) {
+                json.beginObject();
+                json.key( "command" ).string( "run", 3 );
+                json.key( "arguments" ).beginArray().endArray();
+                json.endObject();
+            };
+            latencies.push_back( client.send( "workspace/executeCommand", command ) );
+        }
+        else
+        {
+            static const char* QUERIES[] = {
+                "textDocument/documentSymbol",
+                "textDocument/foldingRange",
+                "textDocument/semanticTokens/full",
+                "textDocument/diagnostic",
+            };
+            const auto method = QUERIES[ random() % 4 ];
+            latencies.push_back( client.send( method, [&]( casmd::JsonWriter& json ) {
+                json.beginObject();
+                textDocument( json, uri );
+                json.endObject();
+            } ) );
+        }
+
+        pm.stream().flush( sink );
+        discard.str( "" );
+
+        if( ( iteration + 1 ) % window == 0 )
+        {
+            samples.push_back(
+                { residentSetSize(), heapUsage(), percentile( latencies, 0.99 ) } );
+            latencies.clear();
+
+            const auto& sample = samples.back();
+            std::cerr << "soak: " << ( iteration + 1 ) << " requests, rss " << sample.rss
+                      << " bytes, heap " << sample.heap << " bytes, p99 " << sample.p99
+                      << " ms\n";
+        }
+    }
+
+    EXPECT_GT( client.frames(), 0 );
+    ASSERT_GT( samples.size(), WARMUP_WINDOWS );
+
+    const auto& baseline = samples[ WARMUP_WINDOWS - 1 ];
+    const auto& last = samples.back();
+
+    EXPECT_LE( last.rss, baseline.rss * MEMORY_FACTOR + MEMORY_SLACK )
+        << "resident set size grows unboundedly";
+    EXPECT_LE( last.heap, baseline.heap * MEMORY_FACTOR + MEMORY_SLACK )
+        << "live heap allocations grow unboundedly";
+    EXPECT_LE( last.p99, baseline.p99 * LATENCY_FACTOR + LATENCY_SLACK )
+        << "p99 latency drifts";
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
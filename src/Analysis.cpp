@@ -0,0 +1,125 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Analysis.h"
+
+#include "DiagnosticFormatter.h"
+#include "PassLock.h"
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libpass/PassManager>
+#include <libpass/analyze/LoadFilePass>
+
+using namespace casmd;
+using namespace libpass;
+using namespace libstdhl;
+
+// rough amount of AST, symbol table and type annotation bytes which are
+// allocated per character of specification text during an analysis
+static constexpr std::size_t ANALYSIS_BYTES_PER_CHARACTER = 24;
+
+Analysis::Analysis( const File::TextDocument& file )
+: m_file( file )
+, m_result()
+, m_diagnostics()
+, m_footprint( 0 )
+, m_error()
+{
+}
+
+void Analysis::run( std::ostream& stream )
+{
+    // file is already in-memory, by-pass the LoadFilePass by setting its pass result
+    PassResult pr;
+    pr.setOutput< LoadFilePass >( m_file );
+
+    PassManager pm;
+    pm.setDefaultResult( pr );
+    pm.setDefaultPass< libcasm_fe::ConsistencyCheckPass >();
+
+    try
+    {
+        PassLock lock;
+        pm.run();
+    }
+    catch( const std::exception& e )
+    {
+        m_error = "pass manager triggered an exception: '" + std::string( e.what() ) + "'";
+    }
+
+    DiagnosticFormatter formatter( "casmd" );
+    Log::OutputStreamSink sink( stream, formatter );
+    pm.stream().flush( sink );
+
+    m_result = pm.result();
+    m_diagnostics = formatter.diagnostics();
+    m_footprint = m_file.data().size() * ANALYSIS_BYTES_PER_CHARACTER;
+}
+
+const PassResult& Analysis::result( void ) const
+{
+    return m_result;
+}
+
+const std::vector< Diagnostic >& Analysis::diagnostics( void ) const
+{
+    return m_diagnostics;
+}
+
+std::size_t Analysis::footprint( void ) const
+{
+    return m_footprint;
+}
+
+const std::string& Analysis::error( void ) const
+{
+    return m_error;
+}
+
+u1 Analysis::success( void ) const
+{
+    if( not m_error.empty() )
+    {
+        return false;
+    }
+
+    for( const auto& diagnostic : m_diagnostics )
+    {
+        if( diagnostic.severity == Diagnostic::ERROR )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,94 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_ANALYSIS_H_
+#define _CASMD_ANALYSIS_H_
+
+/**
+   @brief    consistency check pipeline of a single text document
+
+   Runs the 'ConsistencyCheckPass' pipeline on an in-memory text document.
+   It is used by the language server for every document revision and by the
+   batch 'check' mode for every file.
+*/
+
+#include "Diagnostic.h"
+
+#include <libpass/PassResult>
+#include <libstdhl/data/file/TextDocument>
+
+#include <ostream>
+
+namespace casmd
+{
+    class Analysis
+    {
+      public:
+        Analysis( const libstdhl::File::TextDocument& file );
+
+        /**
+           runs the pipeline, the formatted log of the passes is written to
+           the provided stream
+        */
+        void run( std::ostream& stream );
+
+        const libpass::PassResult& result( void ) const;
+
+        const std::vector< Diagnostic >& diagnostics( void ) const;
+
+        /**
+           estimated bytes of the AST, symbol table and type annotations of
+           the analysis generation
+        */
+        std::size_t footprint( void ) const;
+
+        /**
+           message of an exception which aborted the pipeline, or empty
+        */
+        const std::string& error( void ) const;
+
+        /**
+           'true' if the pipeline finished without an error diagnostic
+        */
+        u1 success( void ) const;
+
+      private:
+        const libstdhl::File::TextDocument& m_file;
+        libpass::PassResult m_result;
+        std::vector< Diagnostic > m_diagnostics;
+        std::size_t m_footprint;
+        std::string m_error;
+    };
+}
+
+#endif  // _CASMD_ANALYSIS_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
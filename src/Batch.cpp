@@ -0,0 +1,462 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Batch.h"
+
+#include "Analysis.h"
+#include "Execution.h"
+#include "JsonWriter.h"
+#include "ThreadPool.h"
+
+#include <libstdhl/String>
+#include <libstdhl/net/lsp/LSP>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace casmd;
+using namespace libstdhl;
+
+static const char* severityName( const Diagnostic::Severity severity )
+{
+    switch( severity )
+    {
+        case Diagnostic::ERROR:
+        {
+            return "error";
+        }
+        case Diagnostic::WARNING:
+        {
+            return "warning";
+        }
+        case Diagnostic::INFORMATION:
+        {
+            return "information";
+        }
+        case Diagnostic::HINT:
+        {
+            return "hint";
+        }
+        default:
+        {
+            return "none";
+        }
+    }
+}
+
+static std::string fileUri( const std::string& path )
+{
+    if( String::startsWith( path, "/" ) )
+    {
+        return "file://" + path;
+    }
+
+    char directory[ 4096 ];
+    if( not ::getcwd( directory, sizeof( directory ) ) )
+    {
+        return "file://" + path;
+    }
+
+    return "file://" + std::string( directory ) + "/" + path;
+}
+
+static void collectDirectory( const std::string& directory, std::vector< std::string >& files )
+{
+    auto handle = ::opendir( directory.c_str() );
+    if( not handle )
+    {
+        throw std::invalid_argument( "unable to open directory '" + directory + "'" );
+    }
+
+    while( auto entry = ::readdir( handle ) )
+    {
+        const std::string name = entry->d_name;
+        if( name == "." or name == ".." )
+        {
+            continue;
+        }
+
+        const auto path = directory + "/" + name;
+        struct stat status;
+        if( ::stat( path.c_str(), &status ) != 0 )
+        {
+            continue;
+        }
+
+        if( S_ISDIR( status.st_mode ) )
+        {
+            collectDirectory( path, files );
+        }
+        else if( S_ISREG( status.st_mode ) and String::endsWith( name, Batch::EXTENSION ) )
+        {
+            files.emplace_back( path );
+        }
+    }
+
+    ::closedir( handle );
+}
+
+static void diagnosticRecord(
+    const std::string& path,
+    const Diagnostic& diagnostic,
+    const Batch::Format format,
+    std::string& record )
+{
+    if( format == Batch::Format::JSON )
+    {
+        JsonWriter json( record );
+        json.beginObject();
+        json.key( "file" ).string( path );
+        json.key( "line" ).number( diagnostic.startLine + 1 );
+        json.key( "column" ).number( diagnostic.startCharacter + 1 );
+        json.key( "endLine" ).number( diagnostic.endLine + 1 );
+        json.key( "endColumn" ).number( diagnostic.endCharacter + 1 );
+        json.key( "severity" ).string( severityName( diagnostic.severity ) );
+        json.key( "message" ).string( diagnostic.message );
+        json.endObject();
+        record += "\n";
+    }
+    else
+    {
+        record += path + ":" + std::to_string( diagnostic.startLine + 1 ) + ":" +
+                  std::to_string( diagnostic.startCharacter + 1 ) + ": " + diagnostic.message +
+                  "\n";
+    }
+}
+
+Batch::Batch( const std::vector< std::string >& paths, const std::size_t jobs, const Format format )
+: m_files( collect( paths ) )
+, m_jobs( jobs )
+, m_format( format )
+, m_backend( Execution::Backend::AST )
+{
+}
+
+const std::vector< std::string >& Batch::files( void ) const
+{
+    return m_files;
+}
+
+void Batch::setBackend( const Execution::Backend backend )
+{
+    m_backend = backend;
+}
+
+int Batch::check( std::ostream& output )
+{
+    std::atomic< std::size_t > failures( 0 );
+
+    failures += process(
+        [&]( const std::size_t index ) {
+            const auto& path = m_files[ index ];
+            std::string record = "";
+
+            Diagnostic failure;
+            failure.startLine = failure.startCharacter = 0;
+            failure.endLine = failure.endCharacter = 0;
+            failure.severity = Diagnostic::ERROR;
+
+            try
+            {
+                File::TextDocument file(
+                    Network::LSP::DocumentUri::fromString( fileUri( path ) ), "casm" );
+                file.setData( read( path ) );
+
+                std::ostringstream log;
+                Analysis analysis( file );
+                analysis.run( log );
+
+                for( const auto& diagnostic : analysis.diagnostics() )
+                {
+                    diagnosticRecord( path, diagnostic, m_format, record );
+                }
+
+                if( not analysis.error().empty() )
+                {
+                    failure.message = analysis.error();
+                    diagnosticRecord( path, failure, m_format, record );
+                }
+
+                if( not analysis.success() )
+                {
+                    failures++;
+                }
+            }
+            catch( const std::exception& e )
+            {
+                failure.message = e.what();
+                diagnosticRecord( path, failure, m_format, record );
+                failures++;
+            }
+
+            return record;
+        },
+        output );
+
+    if( m_format == Format::HUMAN )
+    {
+        output << "checked " << m_files.size() << " files, " << failures.load() << " failed\n";
+    }
+
+    return failures > 0 ? 1 : 0;
+}
+
+int Batch::run( std::ostream& output )
+{
+    std::atomic< std::size_t > failures( 0 );
+
+    // the parallel backend of every concurrently executed file gets its
+    // share of the hardware threads instead of a pool of all of them
+    const auto jobs = std::min(
+        m_jobs > 0 ? m_jobs : ThreadPool::concurrency(),
+        std::max< std::size_t >( m_files.size(), 1 ) );
+    const auto workers = std::max< std::size_t >( ThreadPool::concurrency() / jobs, 1 );
+
+    failures += process(
+        [&]( const std::size_t index ) {
+            const auto& path = m_files[ index ];
+            std::string record = "";
+
+            std::string status = "ok";
+            std::string error = "";
+            std::string result = "";
+            std::vector< Diagnostic > diagnostics;
+            i64 steps = -1;
+            u64 duration = 0;
+
+            try
+            {
+                File::TextDocument file(
+                    Network::LSP::DocumentUri::fromString( fileUri( path ) ), "casm" );
+                file.setData( read( path ) );
+
+                std::ostringstream log;
+                Execution execution( file );
+                execution.setBackend( m_backend );
+                execution.setWorkers( workers );
+                execution.run( log );
+
+                result = execution.output();
+                diagnostics = execution.diagnostics();
+                error = execution.error();
+                steps = execution.steps();
+                duration = execution.duration();
+
+                if( not execution.success() )
+                {
+                    status = "failed";
+                }
+            }
+            catch( const std::exception& e )
+            {
+                status = "error";
+                error = e.what();
+            }
+
+            const i64 exitCode = status == "ok" ? 0 : 1;
+            if( exitCode != 0 )
+            {
+                failures++;
+            }
+
+            if( m_format == Format::JSON )
+            {
+                JsonWriter json( record );
+                json.beginObject();
+                json.key( "file" ).string( path );
+                json.key( "status" ).string( status );
+                json.key( "exitCode" ).number( exitCode );
+                json.key( "steps" );
+                if( steps < 0 )
+                {
+                    json.null();
+                }
+                else
+                {
+                    json.number( steps );
+                }
+                json.key( "time" ).number( static_cast< i64 >( duration / 1000 ) );
+                json.key( "output" ).string( result );
+                json.key( "error" );
+                if( error.empty() )
+                {
+                    json.null();
+                }
+                else
+                {
+                    json.string( error );
+                }
+                json.key( "diagnostics" );
+                Diagnostic::serialize( json, diagnostics );
+                json.endObject();
+                record += "\n";
+            }
+            else
+            {
+                record += path + ": " + status + " (" + std::to_string( duration / 1000000 ) +
+                          " ms)\n";
+                record += result;
+                if( not result.empty() and result.back() != '\n' )
+                {
+                    record += "\n";
+                }
+
+                for( const auto& diagnostic : diagnostics )
+                {
+                    diagnosticRecord( path, diagnostic, m_format, record );
+                }
+
+                if( not error.empty() )
+                {
+                    record += path + ": " + error + "\n";
+                }
+            }
+
+            return record;
+        },
+        output );
+
+    if( m_format == Format::HUMAN )
+    {
+        output << "executed " << m_files.size() << " files, " << failures.load() << " failed\n";
+    }
+
+    return failures > 0 ? 1 : 0;
+}
+
+std::vector< std::string > Batch::collect( const std::vector< std::string >& paths )
+{
+    std::vector< std::string > files;
+
+    for( const auto& path : paths )
+    {
+        struct stat status;
+        if( ::stat( path.c_str(), &status ) != 0 )
+        {
+            throw std::invalid_argument( "unable to find path '" + path + "'" );
+        }
+
+        if( S_ISDIR( status.st_mode ) )
+        {
+            collectDirectory( path, files );
+        }
+        else
+        {
+            files.emplace_back( path );
+        }
+    }
+
+    std::sort( files.begin(), files.end() );
+    files.erase( std::unique( files.begin(), files.end() ), files.end() );
+    return files;
+}
+
+std::string Batch::read( const std::string& path )
+{
+    std::ifstream stream( path, std::ios::in | std::ios::binary );
+    if( not stream )
+    {
+        throw std::invalid_argument( "unable to read file '" + path + "'" );
+    }
+
+    std::ostringstream content;
+    content << stream.rdbuf();
+    return content.str();
+}
+
+std::size_t Batch::process(
+    const std::function< std::string( const std::size_t index ) >& task,
+    std::ostream& output ) const
+{
+    const auto count = m_files.size();
+    std::atomic< std::size_t > aborted( 0 );
+
+    std::vector< std::string > records( count );
+    std::vector< char > finished( count, false );
+    std::mutex lock;
+    std::condition_variable ready;
+
+    ThreadPool pool( m_jobs );
+
+    for( std::size_t index = 0; index < count; index++ )
+    {
+        pool.submit( [&, index]() {
+            // a task which throws still finishes its record, otherwise the
+            // writer below waits for it forever
+            std::string record = "";
+            try
+            {
+                record = task( index );
+            }
+            catch( ... )
+            {
+                Diagnostic failure;
+                failure.startLine = failure.startCharacter = 0;
+                failure.endLine = failure.endCharacter = 0;
+                failure.severity = Diagnostic::ERROR;
+                failure.message = "unknown exception";
+                diagnosticRecord( m_files[ index ], failure, m_format, record );
+                aborted++;
+            }
+            {
+                std::lock_guard< std::mutex > guard( lock );
+                records[ index ] = std::move( record );
+                finished[ index ] = true;
+            }
+            ready.notify_all();
+        } );
+    }
+
+    for( std::size_t index = 0; index < count; index++ )
+    {
+        std::string record;
+        {
+            std::unique_lock< std::mutex > guard( lock );
+            ready.wait( guard, [&]() { return finished[ index ]; } );
+            record = std::move( records[ index ] );
+        }
+        output << record << std::flush;
+    }
+
+    pool.wait();
+    return aborted;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,129 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_BATCH_H_
+#define _CASMD_BATCH_H_
+
+/**
+   @brief    command-line batch processing of many specification files
+
+   The files are processed concurrently on a thread pool, but the records of
+   the files are emitted in the sorted order of their paths as soon as all
+   preceding files are finished, therefore the output is deterministic.
+   The pass runs of the files are serialized by the 'PassLock', the flat
+   backend and the formatting of the records run concurrently.
+*/
+
+#include "Execution.h"
+
+#include <libstdhl/Type>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+
+    class Batch
+    {
+      public:
+        enum class Format
+        {
+            HUMAN,
+            JSON
+        };
+
+        static constexpr const char* EXTENSION = ".casm";
+
+        /**
+           'jobs' is the amount of worker threads, zero selects the amount of
+           hardware threads
+        */
+        Batch(
+            const std::vector< std::string >& paths,
+            const std::size_t jobs,
+            const Format format );
+
+        const std::vector< std::string >& files( void ) const;
+
+        /**
+           backend of the numeric executions of 'run', the default is 'AST'.
+           With 'PARALLEL' the hardware threads are divided among the files
+           which are executed concurrently
+        */
+        void setBackend( const Execution::Backend backend );
+
+        /**
+           checks all files with the consistency check pipeline, returns the
+           process exit code
+        */
+        int check( std::ostream& output );
+
+        /**
+           executes all files with the numeric execution pipeline, every file
+           yields one record with its status, exit code, executed steps,
+           wall time in microseconds and captured output, returns the
+           process exit code
+        */
+        int run( std::ostream& output );
+
+        /**
+           collects the files of the given paths, directories are searched
+           recursively for files with the specification extension
+        */
+        static std::vector< std::string > collect( const std::vector< std::string >& paths );
+
+        static std::string read( const std::string& path );
+
+      private:
+        /**
+           runs 'task' for every file on the pool and writes the returned
+           records in file order to 'output', returns the amount of tasks
+           which aborted with an exception
+        */
+        std::size_t process(
+            const std::function< std::string( const std::size_t index ) >& task,
+            std::ostream& output ) const;
+
+      private:
+        std::vector< std::string > m_files;
+        std::size_t m_jobs;
+        Format m_format;
+        Execution::Backend m_backend;
+    };
+}
+
+#endif  // _CASMD_BATCH_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
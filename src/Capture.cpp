@@ -0,0 +1,104 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Capture.h"
+
+#include <iostream>
+#include <mutex>
+
+using namespace casmd;
+
+// target buffer of the current thread, or 'nullptr' for the original buffer
+static thread_local std::streambuf* s_target = nullptr;
+
+namespace
+{
+    class DispatchBuffer final : public std::streambuf
+    {
+      public:
+        DispatchBuffer( std::streambuf* original )
+        : m_original( original )
+        {
+        }
+
+      protected:
+        int_type overflow( int_type c ) override
+        {
+            return target()->sputc( traits_type::to_char_type( c ) );
+        }
+
+        std::streamsize xsputn( const char_type* s, std::streamsize count ) override
+        {
+            return target()->sputn( s, count );
+        }
+
+        int sync( void ) override
+        {
+            return target()->pubsync();
+        }
+
+      private:
+        std::streambuf* target( void ) const
+        {
+            return s_target ? s_target : m_original;
+        }
+
+      private:
+        std::streambuf* m_original;
+    };
+
+    std::once_flag s_install;
+}
+
+Capture::Capture( void )
+: m_sink()
+, m_previous( s_target )
+{
+    std::call_once( s_install, []() {
+        // intentionally never destroyed, 'std::cout' refers to it until the exit
+        std::cout.rdbuf( new DispatchBuffer( std::cout.rdbuf() ) );
+    } );
+
+    s_target = m_sink.rdbuf();
+}
+
+Capture::~Capture( void )
+{
+    std::cout.flush();
+    s_target = m_previous;
+}
+
+std::string Capture::str( void ) const
+{
+    return m_sink.str();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,71 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_CAPTURE_H_
+#define _CASMD_CAPTURE_H_
+
+/**
+   @brief    per-thread capture of the standard output stream
+
+   The passes print the output of a model to 'std::cout'.  Instead of
+   swapping the buffer of the global stream, which is visible to all
+   threads, 'std::cout' is routed once through a dispatching buffer and a
+   capture only redirects the output of its own thread into an isolated
+   sink.  Threads without a capture still write to the original buffer.
+*/
+
+#include <sstream>
+#include <string>
+
+namespace casmd
+{
+    class Capture
+    {
+      public:
+        Capture( void );
+
+        ~Capture( void );
+
+        Capture( const Capture& ) = delete;
+
+        Capture& operator=( const Capture& ) = delete;
+
+        std::string str( void ) const;
+
+      private:
+        std::ostringstream m_sink;
+        std::streambuf* m_previous;
+    };
+}
+
+#endif  // _CASMD_CAPTURE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,185 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "DependencyGraph.h"
+
+#include <algorithm>
+
+using namespace casmd;
+
+u1 DependencyGraph::update( const std::string& uri, const Interface& specification )
+{
+    auto& node = m_nodes[ uri ];
+
+    for( const auto& import : node.imports )
+    {
+        m_nodes[ import ].dependents.erase( uri );
+    }
+
+    node.imports = specification.imports();
+
+    for( const auto& import : node.imports )
+    {
+        m_nodes[ import ].dependents.emplace( uri );
+    }
+
+    // 'node' is still valid, rehashing does not invalidate references
+    const auto changed = not node.known or node.fingerprint != specification.fingerprint();
+    node.fingerprint = specification.fingerprint();
+    node.known = true;
+    return changed;
+}
+
+void DependencyGraph::remove( const std::string& uri )
+{
+    auto node = m_nodes.find( uri );
+    if( node == m_nodes.end() )
+    {
+        return;
+    }
+
+    for( const auto& import : node->second.imports )
+    {
+        m_nodes[ import ].dependents.erase( uri );
+    }
+
+    if( node->second.dependents.empty() )
+    {
+        m_nodes.erase( node );
+    }
+    else
+    {
+        // still imported by other documents, only its own edges are dropped
+        node->second.imports.clear();
+        node->second.known = false;
+    }
+}
+
+const std::vector< std::string >& DependencyGraph::imports( const std::string& uri ) const
+{
+    static const std::vector< std::string > none;
+
+    const auto node = m_nodes.find( uri );
+    return node != m_nodes.end() ? node->second.imports : none;
+}
+
+std::vector< std::vector< std::string > > DependencyGraph::dependents(
+    const std::string& uri ) const
+{
+    // collect the transitive dependents
+    std::unordered_map< std::string, std::size_t > pending;
+    std::vector< std::string > stack = { uri };
+
+    while( not stack.empty() )
+    {
+        const auto current = stack.back();
+        stack.pop_back();
+
+        const auto node = m_nodes.find( current );
+        if( node == m_nodes.end() )
+        {
+            continue;
+        }
+
+        for( const auto& dependent : node->second.dependents )
+        {
+            if( dependent != uri and pending.emplace( dependent, 0 ).second )
+            {
+                stack.emplace_back( dependent );
+            }
+        }
+    }
+
+    // count the imports of every dependent which are dependents themselves
+    for( auto& entry : pending )
+    {
+        for( const auto& import : imports( entry.first ) )
+        {
+            if( pending.count( import ) > 0 )
+            {
+                entry.second++;
+            }
+        }
+    }
+
+    std::vector< std::vector< std::string > > levels;
+
+    while( not pending.empty() )
+    {
+        std::vector< std::string > level;
+        for( const auto& entry : pending )
+        {
+            if( entry.second == 0 )
+            {
+                level.emplace_back( entry.first );
+            }
+        }
+
+        if( level.empty() )
+        {
+            // only import cycles are left
+            for( const auto& entry : pending )
+            {
+                level.emplace_back( entry.first );
+            }
+        }
+
+        std::sort( level.begin(), level.end() );
+
+        for( const auto& resolved : level )
+        {
+            pending.erase( resolved );
+        }
+
+        for( const auto& resolved : level )
+        {
+            for( const auto& dependent : m_nodes.at( resolved ).dependents )
+            {
+                auto entry = pending.find( dependent );
+                if( entry != pending.end() and entry->second > 0 )
+                {
+                    entry->second--;
+                }
+            }
+        }
+
+        levels.emplace_back( std::move( level ) );
+    }
+
+    return levels;
+}
+
+std::size_t DependencyGraph::size( void ) const
+{
+    return m_nodes.size();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,95 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_DEPENDENCY_GRAPH_H_
+#define _CASMD_DEPENDENCY_GRAPH_H_
+
+/**
+   @brief    import dependencies between the documents of a workspace
+
+   Every analyzed document records the URIs it imports together with the
+   fingerprint of its own interface.  The graph answers which documents
+   transitively depend on a changed document, grouped into levels in
+   topological order: the documents of one level only depend on documents
+   of preceding levels and can be re-analyzed in parallel.
+*/
+
+#include "Interface.h"
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+
+    class DependencyGraph
+    {
+      public:
+        /**
+           replaces the imports and the interface of 'uri', returns 'true' if
+           the interface fingerprint changed or was not known before
+        */
+        u1 update( const std::string& uri, const Interface& specification );
+
+        void remove( const std::string& uri );
+
+        const std::vector< std::string >& imports( const std::string& uri ) const;
+
+        /**
+           transitive dependents of 'uri' in topological levels, documents of
+           an import cycle are placed together in the last level
+        */
+        std::vector< std::vector< std::string > > dependents( const std::string& uri ) const;
+
+        std::size_t size( void ) const;
+
+      private:
+        struct Node
+        {
+            std::vector< std::string > imports;
+            std::unordered_set< std::string > dependents;
+            u64 fingerprint = 0;
+            u1 known = false;
+        };
+
+      private:
+        std::unordered_map< std::string, Node > m_nodes;
+    };
+}
+
+#endif  // _CASMD_DEPENDENCY_GRAPH_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,67 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Diagnostic.h"
+
+using namespace casmd;
+
+void Diagnostic::serialize( JsonWriter& json ) const
+{
+    json.beginObject();
+    json.key( "range" ).beginObject();
+    json.key( "start" ).beginObject();
+    json.key( "line" ).number( startLine );
+    json.key( "character" ).number( startCharacter );
+    json.endObject();
+    json.key( "end" ).beginObject();
+    json.key( "line" ).number( endLine );
+    json.key( "character" ).number( endCharacter );
+    json.endObject();
+    json.endObject();
+    if( severity != NONE )
+    {
+        json.key( "severity" ).number( severity );
+    }
+    json.key( "message" ).string( message );
+    json.endObject();
+}
+
+void Diagnostic::serialize( JsonWriter& json, const std::vector< Diagnostic >& diagnostics )
+{
+    json.beginArray();
+    for( const auto& diagnostic : diagnostics )
+    {
+        diagnostic.serialize( json );
+    }
+    json.endArray();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
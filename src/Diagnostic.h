@@ -0,0 +1,82 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_DIAGNOSTIC_H_
+#define _CASMD_DIAGNOSTIC_H_
+
+/**
+   @brief    compact diagnostic of an analysis or execution
+
+   Plain representation of a LSP diagnostic which is cached per document and
+   serialized directly into an outbound frame.  Lines and characters are
+   zero-based like in the LSP, the characters are bytes until the document
+   encodes them to UTF-16 code units.
+*/
+
+#include "JsonWriter.h"
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u8 = libstdhl::u8;
+    using u32 = libstdhl::u32;
+
+    struct Diagnostic
+    {
+        enum Severity : u8
+        {
+            NONE = 0,
+            ERROR = 1,
+            WARNING = 2,
+            INFORMATION = 3,
+            HINT = 4,
+        };
+
+        u32 startLine;
+        u32 startCharacter;
+        u32 endLine;
+        u32 endCharacter;
+        Severity severity;
+        std::string message;
+
+        void serialize( JsonWriter& json ) const;
+
+        static void serialize( JsonWriter& json, const std::vector< Diagnostic >& diagnostics );
+    };
+}
+
+#endif  // _CASMD_DIAGNOSTIC_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -75,7 +75,7 @@ std::string DiagnosticFormatter::visit( libstdhl::Log::Data& item )
     return result;
 }
 
-const std::vector< Network::LSP::Diagnostic >& DiagnosticFormatter::diagnostics( void ) const
+const std::vector< Diagnostic >& DiagnosticFormatter::diagnostics( void ) const
 {
     return m_diagnostics;
 }
@@ -85,33 +85,36 @@ void DiagnosticFormatter::addDiagnostic(
     const libstdhl::Log::LocationItem& location,
     const std::string& msg )
 {
-    Network::LSP::Position start(
-        location.range().begin().line() - 1, location.range().begin().column() - 1 );
-    Network::LSP::Position end(
-        location.range().end().line() - 1, location.range().end().column() - 1 );
-    Network::LSP::Range range( start, end );
-    Network::LSP::Diagnostic diagnostic( range, msg );
+    // the columns of the lexer are one-based bytes, the document encodes them
+    // to UTF-16 characters of its revision
+    Diagnostic diagnostic;
+    diagnostic.startLine = location.range().begin().line() - 1;
+    diagnostic.startCharacter = location.range().begin().column() - 1;
+    diagnostic.endLine = location.range().end().line() - 1;
+    diagnostic.endCharacter = location.range().end().column() - 1;
+    diagnostic.severity = Diagnostic::NONE;
+    diagnostic.message = msg;
 
     switch( level.id() )
     {
         case libstdhl::Log::Level::ID::ERROR:
         {
-            diagnostic.setSeverity( Network::LSP::DiagnosticSeverity::Error );
+            diagnostic.severity = Diagnostic::ERROR;
             break;
         }
         case libstdhl::Log::Level::ID::WARNING:
         {
-            diagnostic.setSeverity( Network::LSP::DiagnosticSeverity::Warning );
+            diagnostic.severity = Diagnostic::WARNING;
             break;
         }
         case libstdhl::Log::Level::ID::INFORMATIONAL:
         {
-            diagnostic.setSeverity( Network::LSP::DiagnosticSeverity::Information );
+            diagnostic.severity = Diagnostic::INFORMATION;
             break;
         }
         case libstdhl::Log::Level::ID::NOTICE:
         {
-            diagnostic.setSeverity( Network::LSP::DiagnosticSeverity::Hint );
+            diagnostic.severity = Diagnostic::HINT;
             break;
         }
         default:
@@ -120,7 +123,7 @@ void DiagnosticFormatter::addDiagnostic(
         }
     }
 
-    m_diagnostics.emplace_back( diagnostic );
+    m_diagnostics.emplace_back( std::move( diagnostic ) );
 }
 
 //
@@ -30,8 +30,9 @@
    TODO
 */
 
+#include "Diagnostic.h"
+
 #include <libstdhl/Log>
-#include <libstdhl/net/lsp/LSP>
 
 namespace casmd
 {
@@ -42,7 +43,7 @@ namespace casmd
 
         std::string visit( libstdhl::Log::Data& item ) override;
 
-        const std::vector< libstdhl::Network::LSP::Diagnostic >& diagnostics( void ) const;
+        const std::vector< Diagnostic >& diagnostics( void ) const;
 
       private:
         void addDiagnostic(
@@ -52,7 +53,7 @@ namespace casmd
 
       private:
         std::string m_name;
-        std::vector< libstdhl::Network::LSP::Diagnostic > m_diagnostics;
+        std::vector< Diagnostic > m_diagnostics;
     };
 }
 
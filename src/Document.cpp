@@ -0,0 +1,317 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Document.h"
+
+#include <atomic>
+
+using namespace casmd;
+using namespace libstdhl;
+using namespace Network;
+using namespace LSP;
+
+// result ids of the diagnostics, shared by all documents so that a reopened
+// document never reuses the id of a previous one
+static std::atomic< u64 > s_diagnosticsResult( 0 );
+
+Document::Document(
+    const DocumentUri& uri,
+    const std::string& languageId,
+    const std::string& text,
+    const i64 revision )
+: m_uri( uri )
+, m_file( uri, languageId )
+, m_lines( text )
+, m_revision( revision )
+, m_open( true )
+, m_analyzed( false )
+, m_analysis()
+, m_diagnostics()
+, m_serializedDiagnostics()
+, m_diagnosticsResultId()
+, m_outlined( false )
+, m_outline()
+, m_lensed( false )
+, m_lenses()
+, m_command()
+, m_execution()
+, m_artifactUsage( 0 )
+, m_tokens()
+, m_tokensResultId()
+, m_tokenized( false )
+, m_profile()
+{
+    m_file.setData( text );
+}
+
+const DocumentUri& Document::uri( void ) const
+{
+    return m_uri;
+}
+
+File::TextDocument& Document::file( void )
+{
+    return m_file;
+}
+
+const File::TextDocument& Document::file( void ) const
+{
+    return m_file;
+}
+
+i64 Document::revision( void ) const
+{
+    return m_revision;
+}
+
+void Document::setText( const std::string& text, const i64 revision )
+{
+    m_file.setData( text );
+    m_lines = LineIndex( m_file.data() );
+    m_revision = revision;
+    m_tokenized = false;
+    evict();
+}
+
+const LineIndex& Document::lines( void ) const
+{
+    return m_lines;
+}
+
+void Document::encode( std::vector< casmd::Diagnostic >& diagnostics ) const
+{
+    const auto& text = m_file.data();
+    for( auto& diagnostic : diagnostics )
+    {
+        diagnostic.startCharacter =
+            m_lines.character( text, diagnostic.startLine, diagnostic.startCharacter );
+        diagnostic.endCharacter =
+            m_lines.character( text, diagnostic.endLine, diagnostic.endCharacter );
+    }
+}
+
+u1 Document::isOpen( void ) const
+{
+    return m_open;
+}
+
+void Document::setOpen( const u1 open )
+{
+    m_open = open;
+}
+
+u1 Document::analyzed( void ) const
+{
+    return m_analyzed;
+}
+
+void Document::setAnalysis(
+    const libpass::PassResult& result,
+    const std::vector< casmd::Diagnostic >& diagnostics,
+    const std::size_t footprint )
+{
+    m_analyzed = true;
+    m_analysis = result;
+    m_tokenized = false;
+    m_diagnostics = diagnostics;
+    encode( m_diagnostics );
+    m_outlined = false;
+    m_outline = Outline();
+    m_lensed = false;
+    m_lenses.clear();
+
+    std::string serialized = "";
+    JsonWriter json( serialized );
+    casmd::Diagnostic::serialize( json, m_diagnostics );
+    if( m_diagnosticsResultId.empty() or serialized != m_serializedDiagnostics )
+    {
+        m_diagnosticsResultId = std::to_string( ++s_diagnosticsResult );
+    }
+    m_serializedDiagnostics = std::move( serialized );
+
+    m_artifactUsage = m_command.size() + m_execution.size();
+    m_artifactUsage += footprint;
+    for( const auto& diagnostic : m_diagnostics )
+    {
+        m_artifactUsage += sizeof( casmd::Diagnostic ) + diagnostic.message.size();
+    }
+}
+
+const libpass::PassResult& Document::analysis( void ) const
+{
+    return m_analysis;
+}
+
+const std::vector< casmd::Diagnostic >& Document::diagnostics( void ) const
+{
+    return m_diagnostics;
+}
+
+const std::string& Document::serializedDiagnostics( void ) const
+{
+    return m_serializedDiagnostics;
+}
+
+const std::string& Document::diagnosticsResultId( void ) const
+{
+    return m_diagnosticsResultId;
+}
+
+u1 Document::outlined( void ) const
+{
+    return m_outlined;
+}
+
+void Document::setOutline( Outline&& outline )
+{
+    if( m_outlined )
+    {
+        m_artifactUsage -= m_outline.usage();
+    }
+
+    m_outlined = true;
+    m_outline = std::move( outline );
+    m_artifactUsage += m_outline.usage();
+}
+
+const Outline& Document::outline( void ) const
+{
+    return m_outline;
+}
+
+u1 Document::lensed( void ) const
+{
+    return m_lensed;
+}
+
+void Document::setLenses( std::string&& lenses )
+{
+    m_artifactUsage -= m_lenses.size();
+    m_lensed = true;
+    m_lenses = std::move( lenses );
+    m_artifactUsage += m_lenses.size();
+}
+
+const std::string& Document::lenses( void ) const
+{
+    return m_lenses;
+}
+
+u1 Document::executed( const std::string& command ) const
+{
+    return m_command == command;
+}
+
+void Document::setExecution( const std::string& command, const std::string& output )
+{
+    m_artifactUsage -= m_command.size() + m_execution.size();
+    m_command = command;
+    m_execution = output;
+    m_artifactUsage += m_command.size() + m_execution.size();
+}
+
+const std::string& Document::execution( void ) const
+{
+    return m_execution;
+}
+
+void Document::evict( void )
+{
+    m_analyzed = false;
+    m_analysis = libpass::PassResult();
+    m_diagnostics.clear();
+    m_diagnostics.shrink_to_fit();
+    m_outlined = false;
+    m_outline = Outline();
+    m_lensed = false;
+    m_lenses.clear();
+    m_lenses.shrink_to_fit();
+    m_command.clear();
+    m_execution.clear();
+    m_execution.shrink_to_fit();
+    m_artifactUsage = 0;
+}
+
+const std::vector< u32 >& Document::tokens( void ) const
+{
+    return m_tokens;
+}
+
+const std::string& Document::tokensResultId( void ) const
+{
+    return m_tokensResultId;
+}
+
+u1 Document::tokenized( void ) const
+{
+    return m_tokenized;
+}
+
+void Document::setTokens( const std::string& resultId, std::vector< u32 >&& tokens )
+{
+    m_tokensResultId = resultId;
+    m_tokens = std::move( tokens );
+    m_tokenized = true;
+}
+
+const Profile& Document::profile( void ) const
+{
+    return m_profile;
+}
+
+void Document::setProfile( Profile&& profile )
+{
+    m_profile = std::move( profile );
+
+    // the lenses show the previous profile
+    m_artifactUsage -= m_lenses.size();
+    m_lensed = false;
+    m_lenses.clear();
+}
+
+std::size_t Document::textUsage( void ) const
+{
+    return m_file.data().size() + m_lines.usage() + m_serializedDiagnostics.size() +
+           m_diagnosticsResultId.size() + m_tokens.size() * sizeof( u32 ) +
+           m_tokensResultId.size() + m_profile.usage();
+}
+
+std::size_t Document::artifactUsage( void ) const
+{
+    return m_artifactUsage;
+}
+
+std::size_t Document::usage( void ) const
+{
+    return textUsage() + artifactUsage();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,242 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_DOCUMENT_H_
+#define _CASMD_DOCUMENT_H_
+
+/**
+   @brief    text document and its cached analysis artifacts
+
+   A document keeps the latest text of a client file together with the
+   artifacts derived from it (pass results incl. the AST, diagnostics and
+   execution results).  The text is only dropped if the document is closed,
+   whereas the artifacts can be evicted at any time and are re-computed on
+   demand.
+*/
+
+#include "Diagnostic.h"
+#include "LineIndex.h"
+#include "Outline.h"
+#include "Profile.h"
+
+#include <libpass/PassResult>
+#include <libstdhl/Type>
+#include <libstdhl/data/file/TextDocument>
+#include <libstdhl/net/lsp/LSP>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using i64 = libstdhl::i64;
+
+    class Document
+    {
+      public:
+        Document(
+            const libstdhl::Network::LSP::DocumentUri& uri,
+            const std::string& languageId,
+            const std::string& text,
+            const i64 revision );
+
+        const libstdhl::Network::LSP::DocumentUri& uri( void ) const;
+
+        libstdhl::File::TextDocument& file( void );
+
+        const libstdhl::File::TextDocument& file( void ) const;
+
+        i64 revision( void ) const;
+
+        /**
+           replaces the text of the document, all artifacts of the previous
+           revision are invalidated
+        */
+        void setText( const std::string& text, const i64 revision );
+
+        /**
+           line index of the current revision
+        */
+        const LineIndex& lines( void ) const;
+
+        /**
+           converts the byte columns of 'diagnostics' reported for the current
+           revision to UTF-16 characters
+        */
+        void encode( std::vector< Diagnostic >& diagnostics ) const;
+
+        u1 isOpen( void ) const;
+
+        void setOpen( const u1 open );
+
+        //
+        //
+        // Artifacts
+        //
+
+        u1 analyzed( void ) const;
+
+        /**
+           stores the pass results of an analysis, 'footprint' is the
+           estimated amount of bytes of the analysis generation.  The
+           characters of the 'diagnostics' are encoded, see 'encode'
+        */
+        void setAnalysis(
+            const libpass::PassResult& result,
+            const std::vector< Diagnostic >& diagnostics,
+            const std::size_t footprint );
+
+        const libpass::PassResult& analysis( void ) const;
+
+        const std::vector< Diagnostic >& diagnostics( void ) const;
+
+        /**
+           serialized 'Diagnostic[]' of the last analysis, it is kept like
+           the text across revisions and evictions
+        */
+        const std::string& serializedDiagnostics( void ) const;
+
+        /**
+           result id of the diagnostics for pull requests, it increases
+           whenever the diagnostics of the document change and stays the
+           same for edited or re-analyzed revisions with equal diagnostics
+        */
+        const std::string& diagnosticsResultId( void ) const;
+
+        u1 outlined( void ) const;
+
+        /**
+           stores the outline derived from the analysis of this revision
+        */
+        void setOutline( Outline&& outline );
+
+        const Outline& outline( void ) const;
+
+        u1 lensed( void ) const;
+
+        /**
+           stores the serialized 'CodeLens[]' of this revision
+        */
+        void setLenses( std::string&& lenses );
+
+        const std::string& lenses( void ) const;
+
+        u1 executed( const std::string& command ) const;
+
+        void setExecution( const std::string& command, const std::string& output );
+
+        const std::string& execution( void ) const;
+
+        /**
+           releases all cached artifacts, the text is kept
+        */
+        void evict( void );
+
+        //
+        //
+        // Client State
+        //
+
+        /**
+           semantic tokens last sent to the client, they are the base of the
+           next delta request and are therefore kept like the text across
+           revisions and evictions
+        */
+        const std::vector< u32 >& tokens( void ) const;
+
+        const std::string& tokensResultId( void ) const;
+
+        /**
+           'true' if the semantic tokens were collected from this revision
+           and its current analysis
+        */
+        u1 tokenized( void ) const;
+
+        void setTokens( const std::string& resultId, std::vector< u32 >&& tokens );
+
+        /**
+           rule profile of the last profiling execution, it is kept across
+           revisions and the code lenses are derived from it
+        */
+        const Profile& profile( void ) const;
+
+        void setProfile( Profile&& profile );
+
+        //
+        //
+        // Memory
+        //
+
+        /**
+           bytes of the text, its line index, the last diagnostics and the
+           client state
+        */
+        std::size_t textUsage( void ) const;
+
+        std::size_t artifactUsage( void ) const;
+
+        std::size_t usage( void ) const;
+
+      private:
+        libstdhl::Network::LSP::DocumentUri m_uri;
+        libstdhl::File::TextDocument m_file;
+        LineIndex m_lines;
+        i64 m_revision;
+        u1 m_open;
+
+        u1 m_analyzed;
+        libpass::PassResult m_analysis;
+        std::vector< Diagnostic > m_diagnostics;
+        std::string m_serializedDiagnostics;
+        std::string m_diagnosticsResultId;
+
+        u1 m_outlined;
+        Outline m_outline;
+
+        u1 m_lensed;
+        std::string m_lenses;
+
+        std::string m_command;
+        std::string m_execution;
+
+        std::size_t m_artifactUsage;
+
+        std::vector< u32 > m_tokens;
+        std::string m_tokensResultId;
+        u1 m_tokenized;
+        Profile m_profile;
+    };
+}
+
+#endif  // _CASMD_DOCUMENT_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,332 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Execution.h"
+
+#include "Capture.h"
+#include "DiagnosticFormatter.h"
+#include "Machine.h"
+#include "PassLock.h"
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libcasm-fe/execute/NumericExecutionPass>
+#include <libcasm-fe/execute/SymbolicExecutionPass>
+#include <libpass/PassManager>
+#include <libpass/PassResult>
+#include <libpass/analyze/LoadFilePass>
+
+#include <chrono>
+
+using namespace casmd;
+using namespace libpass;
+using namespace libstdhl;
+
+Execution::Execution( const File::TextDocument& file, const Kind kind )
+: m_file( file )
+, m_kind( kind )
+, m_backend( Backend::AST )
+, m_executed( Backend::AST )
+, m_workers( 0 )
+, m_fallback()
+, m_output()
+, m_diagnostics()
+, m_error()
+, m_steps( -1 )
+, m_duration( 0 )
+, m_recorder()
+, m_snapshotInterval( 0 )
+, m_snapshotHandler()
+, m_resume()
+, m_resuming( false )
+, m_yield()
+{
+}
+
+void Execution::run( std::ostream& stream )
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto snapshots = m_kind == Kind::NUMERIC and m_snapshotInterval > 0;
+    const auto resuming = m_kind == Kind::NUMERIC and m_resuming;
+
+    // only the state of the flat backend can be serialized, an execution
+    // with snapshots runs on it as long as the specification is supported
+    const auto flat =
+        m_kind == Kind::NUMERIC and ( m_backend != Backend::AST or snapshots or resuming );
+    const auto instrumented = m_kind == Kind::PROFILE;
+
+    Machine machine;
+    if( m_kind == Kind::NUMERIC and m_backend == Backend::PARALLEL )
+    {
+        machine.setParallel( m_workers );
+    }
+
+    const auto yield = [this]( void ) {
+        if( m_yield )
+        {
+            m_yield();
+        }
+    };
+
+    std::function< void( u64 ) > stepHandler;
+    if( snapshots or m_yield )
+    {
+        // the state a resumed execution starts with is not taken again
+        const auto first = resuming ? m_resume.step() : 0;
+        stepHandler = [this, &machine, &yield, snapshots, first]( const u64 step ) {
+            if( snapshots and step > first and step % m_snapshotInterval == 0 )
+            {
+                m_snapshotHandler( machine.snapshot() );
+            }
+            yield();
+        };
+    }
+
+    PassResult pr;
+    pr.setOutput< LoadFilePass >( m_file );
+
+    PassManager pm;
+    pm.setDefaultResult( pr );
+
+    // an execution which yields runs the analysis and the execution passes
+    // one after the other to yield in between
+    const auto staged = instrumented or ( not flat and m_yield );
+
+    if( m_kind == Kind::SYMBOLIC and not staged )
+    {
+        pm.setDefaultPass< libcasm_fe::SymbolicExecutionPass >();
+    }
+    else if( staged or flat )
+    {
+        pm.setDefaultPass< libcasm_fe::ConsistencyCheckPass >();
+    }
+    else
+    {
+        pm.setDefaultPass< libcasm_fe::NumericExecutionPass >();
+    }
+
+    auto executed = false;
+
+    {
+        Capture capture;
+
+        try
+        {
+            auto compiled = false;
+            {
+                PassLock lock;
+                pm.run();
+            }
+
+            if( flat )
+            {
+                compiled = machine.compile( pm.result() );
+                if( compiled and resuming and not machine.restore( m_resume ) )
+                {
+                    m_error = "the snapshot does not match the specification";
+                    compiled = false;
+                }
+            }
+            else if( staged )
+            {
+                // the execution continues with the result of the analysis,
+                // which is not run again.  A profile instruments the rule
+                // definitions in between
+                const auto analysis = pm.result();
+                if( analysis.hasOutput< libcasm_fe::ConsistencyCheckPass >() )
+                {
+                    yield();
+                    if( instrumented )
+                    {
+                        m_recorder.instrument( analysis );
+                    }
+                    pm.setDefaultResult( analysis );
+                    if( m_kind == Kind::SYMBOLIC )
+                    {
+                        pm.setDefaultPass< libcasm_fe::SymbolicExecutionPass >();
+                    }
+                    else
+                    {
+                        pm.setDefaultPass< libcasm_fe::NumericExecutionPass >();
+                    }
+                    {
+                        PassLock lock;
+                        pm.run();
+                    }
+                }
+            }
+
+            if( compiled )
+            {
+                yield();
+                executed = machine.run( stepHandler );
+            }
+
+            if( flat and not executed and m_error.empty() )
+            {
+                // the AST interpreter executes the specification from the
+                // initial state and reports the exact diagnostics, also if
+                // the execution was resumed
+                m_fallback = machine.reason();
+                const auto analysis = pm.result();
+                if( analysis.hasOutput< libcasm_fe::ConsistencyCheckPass >() )
+                {
+                    yield();
+                    pm.setDefaultResult( analysis );
+                    pm.setDefaultPass< libcasm_fe::NumericExecutionPass >();
+                    {
+                        PassLock lock;
+                        pm.run();
+                    }
+                }
+            }
+        }
+        catch( const std::exception& e )
+        {
+            m_error = "pass manager triggered an exception: '" + std::string( e.what() ) + "'";
+        }
+
+        m_output = executed ? machine.output() : capture.str();
+    }
+
+    DiagnosticFormatter formatter( "casmd" );
+    Log::OutputStreamSink sink( stream, formatter );
+    pm.stream().flush( sink );
+
+    m_diagnostics = formatter.diagnostics();
+    m_executed = not executed                     ? Backend::AST
+                 : m_backend == Backend::PARALLEL ? Backend::PARALLEL
+                                                  : Backend::FLAT;
+    if( executed )
+    {
+        m_steps = static_cast< i64 >( machine.steps() );
+    }
+    else
+    {
+        m_steps = instrumented ? static_cast< i64 >( m_recorder.steps() ) : -1;
+    }
+
+    m_duration = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                     std::chrono::steady_clock::now() - start )
+                     .count();
+}
+
+void Execution::setSnapshots(
+    const u64 interval, const std::function< void( Snapshot&& ) >& handler )
+{
+    m_snapshotInterval = interval;
+    m_snapshotHandler = handler;
+}
+
+void Execution::resume( const Snapshot& snapshot )
+{
+    m_resume = snapshot;
+    m_resuming = true;
+}
+
+void Execution::setYield( const std::function< void( void ) >& handler )
+{
+    m_yield = handler;
+}
+
+void Execution::setBackend( const Backend backend )
+{
+    m_backend = backend;
+}
+
+void Execution::setWorkers( const std::size_t workers )
+{
+    m_workers = workers;
+}
+
+Execution::Kind Execution::kind( void ) const
+{
+    return m_kind;
+}
+
+Execution::Backend Execution::backend( void ) const
+{
+    return m_executed;
+}
+
+const std::string& Execution::fallback( void ) const
+{
+    return m_fallback;
+}
+
+const std::string& Execution::output( void ) const
+{
+    return m_output;
+}
+
+const std::vector< Diagnostic >& Execution::diagnostics( void ) const
+{
+    return m_diagnostics;
+}
+
+const std::string& Execution::error( void ) const
+{
+    return m_error;
+}
+
+u1 Execution::success( void ) const
+{
+    if( not m_error.empty() )
+    {
+        return false;
+    }
+
+    for( const auto& diagnostic : m_diagnostics )
+    {
+        if( diagnostic.severity == Diagnostic::ERROR )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+i64 Execution::steps( void ) const
+{
+    return m_steps;
+}
+
+Profile Execution::profile( void ) const
+{
+    return m_recorder.profile();
+}
+
+u64 Execution::duration( void ) const
+{
+    return m_duration;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
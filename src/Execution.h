@@ -0,0 +1,186 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_EXECUTION_H_
+#define _CASMD_EXECUTION_H_
+
+/**
+   @brief    numeric or symbolic execution of a single text document
+
+   Runs the execution pipeline on an in-memory text document.  The output
+   of the model is captured in an isolated sink of the executing thread,
+   therefore several executions can run concurrently.
+
+   A numeric execution can use the flat backend of 'Machine' instead of the
+   AST interpreter, sequentially or with large parallel rules evaluated on
+   all cores.  A specification outside of its subset is executed by the AST
+   interpreter, the output is the same with all backends.
+*/
+
+#include "Diagnostic.h"
+#include "Profile.h"
+#include "Snapshot.h"
+
+#include <libstdhl/data/file/TextDocument>
+
+#include <functional>
+#include <ostream>
+
+namespace casmd
+{
+    class Execution
+    {
+      public:
+        enum class Kind
+        {
+            NUMERIC,
+            SYMBOLIC,
+            PROFILE  // numeric execution with instrumented rule definitions
+        };
+
+        enum class Backend
+        {
+            AST,
+            FLAT,
+            PARALLEL  // flat backend with parallel forall rules and blocks
+        };
+
+        Execution( const libstdhl::File::TextDocument& file, const Kind kind = Kind::NUMERIC );
+
+        /**
+           runs the pipeline, the formatted log of the passes is written to
+           the provided stream
+        */
+        void run( std::ostream& stream );
+
+        /**
+           passes a snapshot to 'handler' every 'interval' steps of a numeric
+           execution.  Only the state of the flat backend is serializable,
+           therefore snapshots select it like a resume does.  A fallback to
+           the AST interpreter takes no snapshots
+        */
+        void setSnapshots(
+            const u64 interval, const std::function< void( Snapshot&& ) >& handler );
+
+        /**
+           continues a numeric execution from 'snapshot' instead of the
+           initial state, the output contains the one of the executed steps
+        */
+        void resume( const Snapshot& snapshot );
+
+        /**
+           calls 'handler' at the pass boundaries and before every step of
+           the flat backend, e.g. to serve the queued interactive requests
+           during a long execution.  It is never called while a libcasm-fe
+           pass runs, the handler may run passes itself.  The AST
+           interpreter of a numeric, symbolic or profiling execution
+           therefore only yields between its analysis and its execution
+        */
+        void setYield( const std::function< void( void ) >& handler );
+
+        /**
+           selects the backend of a numeric execution, the default is 'AST'
+        */
+        void setBackend( const Backend backend );
+
+        /**
+           amount of threads of the 'PARALLEL' backend, zero selects the
+           amount of hardware threads (the default)
+        */
+        void setWorkers( const std::size_t workers );
+
+        Kind kind( void ) const;
+
+        /**
+           backend which executed the specification, 'FLAT' if snapshots
+           selected it and 'AST' after a fallback
+        */
+        Backend backend( void ) const;
+
+        /**
+           why the flat backend fell back to the AST interpreter, or empty
+        */
+        const std::string& fallback( void ) const;
+
+        const std::string& output( void ) const;
+
+        const std::vector< Diagnostic >& diagnostics( void ) const;
+
+        /**
+           message of an exception which aborted the pipeline, or empty
+        */
+        const std::string& error( void ) const;
+
+        /**
+           'true' if the pipeline finished without an error diagnostic
+        */
+        u1 success( void ) const;
+
+        /**
+           executed steps incl. the ones of a resumed snapshot, or -1 if the
+           rules of the AST interpreter are not instrumented
+        */
+        i64 steps( void ) const;
+
+        /**
+           rule profile of a 'PROFILE' execution
+        */
+        Profile profile( void ) const;
+
+        /**
+           wall time of the pipeline in nanoseconds
+        */
+        u64 duration( void ) const;
+
+      private:
+        const libstdhl::File::TextDocument& m_file;
+        Kind m_kind;
+        Backend m_backend;
+        Backend m_executed;
+        std::size_t m_workers;
+        std::string m_fallback;
+        std::string m_output;
+        std::vector< Diagnostic > m_diagnostics;
+        std::string m_error;
+        i64 m_steps;
+        u64 m_duration;
+        Profile::Recorder m_recorder;
+        u64 m_snapshotInterval;
+        std::function< void( Snapshot&& ) > m_snapshotHandler;
+        Snapshot m_resume;
+        u1 m_resuming;
+        std::function< void( void ) > m_yield;
+    };
+}
+
+#endif  // _CASMD_EXECUTION_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
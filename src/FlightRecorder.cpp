@@ -0,0 +1,441 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "FlightRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace casmd;
+
+static constexpr char MAGIC[ 8 ] = { 'C', 'A', 'S', 'M', 'D', 'F', 'R', '\0' };
+static constexpr u64 VERSION = 1;
+static constexpr std::size_t MINIMUM_SIZE = 64 * 1024;
+
+struct FlightRecorder::Header
+{
+    char magic[ 8 ];
+    u64 version;
+    u64 capacity;
+    u64 process;
+
+    /**
+       nanoseconds since the epoch when the recorder was opened
+    */
+    u64 start;
+
+    /**
+       total amount of reserved bytes, the ring holds the last 'capacity'
+    */
+    std::atomic< u64 > head;
+
+    u64 reserved[ 2 ];
+};
+
+static_assert( sizeof( std::atomic< u64 > ) == sizeof( u64 ), "unexpected atomic layout" );
+
+namespace
+{
+    /**
+       a record is committed by its position, which is written last
+    */
+    struct Record
+    {
+        u64 position;
+        u64 time;
+        u64 value;
+        libstdhl::u32 size;
+        u16 kind;
+        u16 thread;
+    };
+
+    static_assert( sizeof( Record ) == 32, "unexpected record layout" );
+}
+
+static std::atomic< FlightRecorder* > s_active( nullptr );
+static std::atomic< u16 > s_threads( 0 );
+
+static u64 now( void )
+{
+    return static_cast< u64 >( std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                   std::chrono::system_clock::now().time_since_epoch() )
+                                   .count() );
+}
+
+static u16 threadIndex( void )
+{
+    static thread_local const u16 index = ++s_threads;
+    return index;
+}
+
+static u64 recordLength( const u64 size )
+{
+    return ( sizeof( Record ) + size + 7 ) & ~static_cast< u64 >( 7 );
+}
+
+static const char* kindName( const u16 kind )
+{
+    switch( static_cast< FlightRecorder::Kind >( kind ) )
+    {
+        case FlightRecorder::Kind::INBOUND:
+        {
+            return "in";
+        }
+        case FlightRecorder::Kind::OUTBOUND:
+        {
+            return "out";
+        }
+        case FlightRecorder::Kind::BEGIN:
+        {
+            return "begin";
+        }
+        case FlightRecorder::Kind::END:
+        {
+            return "end";
+        }
+        case FlightRecorder::Kind::NOTE:
+        {
+            return "note";
+        }
+    }
+
+    return nullptr;
+}
+
+//
+//
+// FlightRecorder::Span
+//
+
+FlightRecorder::Span::Span( const char* pass, const std::string& subject )
+: m_name()
+, m_start()
+{
+    if( not enabled() )
+    {
+        return;
+    }
+
+    m_name = subject.empty() ? std::string( pass ) : std::string( pass ) + " " + subject;
+    m_start = std::chrono::steady_clock::now();
+    record( Kind::BEGIN, m_name );
+}
+
+FlightRecorder::Span::~Span( void )
+{
+    if( m_name.empty() )
+    {
+        return;
+    }
+
+    const auto duration = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now() - m_start );
+    record( Kind::END, m_name, static_cast< u64 >( duration.count() ) );
+}
+
+//
+//
+// FlightRecorder
+//
+
+FlightRecorder::FlightRecorder( void )
+: m_path()
+, m_header( nullptr )
+, m_ring( nullptr )
+, m_capacity( 0 )
+, m_mapped( 0 )
+{
+}
+
+FlightRecorder::~FlightRecorder( void )
+{
+    close();
+}
+
+#if defined( _WIN32 )
+
+void FlightRecorder::open( const std::string&, const std::size_t )
+{
+    throw std::runtime_error( "the flight recorder is not supported on this platform" );
+}
+
+void FlightRecorder::close( void )
+{
+}
+
+std::string FlightRecorder::temporary( void )
+{
+    return "casmd.flight";
+}
+
+#else
+
+void FlightRecorder::open( const std::string& path, const std::size_t size )
+{
+    close();
+
+    const u64 capacity = std::max( size, MINIMUM_SIZE ) & ~static_cast< u64 >( 7 );
+    const auto mapped = sizeof( Header ) + capacity;
+
+    const auto fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+    if( fd < 0 )
+    {
+        throw std::runtime_error( "unable to create flight recorder file '" + path + "'" );
+    }
+
+    void* memory = MAP_FAILED;
+    if( ::ftruncate( fd, static_cast< off_t >( mapped ) ) == 0 )
+    {
+        memory = ::mmap( nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    }
+    ::close( fd );
+
+    if( memory == MAP_FAILED )
+    {
+        throw std::runtime_error( "unable to map flight recorder file '" + path + "'" );
+    }
+
+    m_path = path;
+    m_header = static_cast< Header* >( memory );
+    m_ring = static_cast< char* >( memory ) + sizeof( Header );
+    m_capacity = capacity;
+    m_mapped = mapped;
+
+    std::memcpy( m_header->magic, MAGIC, sizeof( MAGIC ) );
+    m_header->version = VERSION;
+    m_header->capacity = capacity;
+    m_header->process = static_cast< u64 >( ::getpid() );
+    m_header->start = now();
+    new( &m_header->head ) std::atomic< u64 >( 0 );
+
+    s_active.store( this, std::memory_order_release );
+}
+
+void FlightRecorder::close( void )
+{
+    if( not m_header )
+    {
+        return;
+    }
+
+    FlightRecorder* self = this;
+    s_active.compare_exchange_strong( self, nullptr );
+
+    ::munmap( m_header, m_mapped );
+    m_header = nullptr;
+    m_ring = nullptr;
+    m_capacity = 0;
+    m_mapped = 0;
+}
+
+std::string FlightRecorder::temporary( void )
+{
+    const auto directory = std::getenv( "TMPDIR" );
+    return std::string( directory and *directory ? directory : "/tmp" ) + "/casmd-" +
+           std::to_string( ::getpid() ) + ".flight";
+}
+
+#endif
+
+const std::string& FlightRecorder::path( void ) const
+{
+    return m_path;
+}
+
+u1 FlightRecorder::enabled( void )
+{
+    return s_active.load( std::memory_order_relaxed ) != nullptr;
+}
+
+void FlightRecorder::record(
+    const Kind kind, const char* data, const std::size_t size, const u64 value )
+{
+    const auto recorder = s_active.load( std::memory_order_acquire );
+    if( recorder )
+    {
+        recorder->append( kind, data, size, value );
+    }
+}
+
+void FlightRecorder::record( const Kind kind, const std::string& data, const u64 value )
+{
+    record( kind, data.data(), data.size(), value );
+}
+
+void FlightRecorder::append( const Kind kind, const char* data, std::size_t size, const u64 value )
+{
+    size = std::min< std::size_t >( size, m_capacity / 4 - sizeof( Record ) );
+    const auto length = recordLength( size );
+    const auto position = m_header->head.fetch_add( length, std::memory_order_relaxed );
+
+    Record record;
+    record.position = position;
+    record.time = now();
+    record.value = value;
+    record.size = static_cast< libstdhl::u32 >( size );
+    record.kind = static_cast< u16 >( kind );
+    record.thread = threadIndex();
+
+    const auto fields = reinterpret_cast< const char* >( &record ) + sizeof( record.position );
+    copy( position + sizeof( record.position ),
+          fields,
+          sizeof( Record ) - sizeof( record.position ) );
+    copy( position + sizeof( Record ), data, size );
+
+    std::atomic_thread_fence( std::memory_order_release );
+    copy( position, &record.position, sizeof( record.position ) );
+}
+
+void FlightRecorder::copy( const u64 position, const void* data, const std::size_t size )
+{
+    const auto offset = position % m_capacity;
+    const auto first = std::min< u64 >( size, m_capacity - offset );
+    std::memcpy( m_ring + offset, data, first );
+    std::memcpy( m_ring, static_cast< const char* >( data ) + first, size - first );
+}
+
+std::size_t FlightRecorder::decode( const std::string& path, std::ostream& output )
+{
+    std::ifstream stream( path, std::ios::in | std::ios::binary );
+    if( not stream )
+    {
+        throw std::invalid_argument( "unable to read flight recorder file '" + path + "'" );
+    }
+
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    const auto content = buffer.str();
+
+    if( content.size() < sizeof( Header ) or
+        std::memcmp( content.data(), MAGIC, sizeof( MAGIC ) ) != 0 )
+    {
+        throw std::invalid_argument( "'" + path + "' is not a flight recorder file" );
+    }
+
+    const auto field = [&]( const std::size_t offset ) {
+        u64 value = 0;
+        std::memcpy( &value, content.data() + offset, sizeof( value ) );
+        return value;
+    };
+
+    const auto version = field( offsetof( Header, version ) );
+    const auto capacity = field( offsetof( Header, capacity ) );
+    const auto process = field( offsetof( Header, process ) );
+    const auto start = field( offsetof( Header, start ) );
+    const auto head = field( offsetof( Header, head ) );
+    if( version != VERSION or capacity == 0 or capacity % 8 != 0 or
+        content.size() < sizeof( Header ) + capacity )
+    {
+        throw std::invalid_argument( "unsupported flight recorder file '" + path + "'" );
+    }
+
+    const auto ring = content.data() + sizeof( Header );
+    const auto read = [&]( const u64 position, void* data, const std::size_t size ) {
+        const auto offset = position % capacity;
+        const auto first = std::min< u64 >( size, capacity - offset );
+        std::memcpy( data, ring + offset, first );
+        std::memcpy( static_cast< char* >( data ) + first, ring, size - first );
+    };
+
+    const u64 oldest = head > capacity ? head - capacity : 0;
+    output << "process " << process << ", " << head << " bytes recorded, "
+           << ( head - oldest ) << " bytes retained\n";
+
+    std::size_t records = 0;
+    u64 skipped = 0;
+    u64 position = oldest;
+    std::string data;
+
+    while( position + sizeof( Record ) <= head )
+    {
+        // a record of a crashed process, or one overwritten by a newer one,
+        // does not carry its own position and is skipped word by word
+        Record record;
+        read( position, &record, sizeof( Record ) );
+        const auto name = kindName( record.kind );
+        const auto length = recordLength( record.size );
+        if( record.position != position or not name or position + length > head )
+        {
+            position += 8;
+            skipped += 8;
+            continue;
+        }
+
+        data.resize( record.size );
+        read( position + sizeof( Record ), &data[ 0 ], record.size );
+        std::replace( data.begin(), data.end(), '\n', ' ' );
+
+        const auto elapsed = record.time >= start ? record.time - start : 0;
+        char prefix[ 64 ];
+        std::snprintf(
+            prefix,
+            sizeof( prefix ),
+            "+%.6f t%u %s ",
+            elapsed / 1e9,
+            static_cast< unsigned >( record.thread ),
+            name );
+        output << prefix << data;
+
+        if( static_cast< Kind >( record.kind ) == Kind::END )
+        {
+            char duration[ 32 ];
+            std::snprintf( duration, sizeof( duration ), " (%.3f ms)", record.value / 1e6 );
+            output << duration;
+        }
+        output << "\n";
+
+        records++;
+        position += length;
+    }
+
+    if( skipped > 0 )
+    {
+        output << skipped << " bytes of incomplete or overwritten records skipped\n";
+    }
+
+    return records;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,157 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_FLIGHT_RECORDER_H_
+#define _CASMD_FLIGHT_RECORDER_H_
+
+/**
+   @brief    crash-safe ring buffer of the recent server activity
+
+   The recorder maps a fixed-size file shared into the process and appends
+   binary records of the inbound and outbound frames and of the begin and
+   end of passes.  A record reserves its space with one atomic increment
+   and is committed by writing its position last, therefore recording is
+   lock-free and a torn record of a crashed process is detected by the
+   decoder.  The pages belong to the file, they survive a crash of the
+   process and can be decoded offline or while the server is still running.
+*/
+
+#include <libstdhl/Type>
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u16 = libstdhl::u16;
+    using u64 = libstdhl::u64;
+
+    class FlightRecorder
+    {
+      public:
+        enum class Kind : u16
+        {
+            INBOUND = 1,  // frame received from the client
+            OUTBOUND,     // frame sent to the client
+            BEGIN,        // start of a pass
+            END,          // end of a pass, the value is its duration in nanoseconds
+            NOTE
+        };
+
+        /**
+           records the begin and the end of a pass in its scope, the name is
+           only built if a recorder is active
+        */
+        class Span
+        {
+          public:
+            Span( const char* pass, const std::string& subject );
+
+            ~Span( void );
+
+          private:
+            std::string m_name;
+            std::chrono::steady_clock::time_point m_start;
+        };
+
+        static constexpr std::size_t DEFAULT_SIZE = 8 * 1024 * 1024;
+
+        FlightRecorder( void );
+
+        ~FlightRecorder( void );
+
+        FlightRecorder( const FlightRecorder& ) = delete;
+
+        FlightRecorder& operator=( const FlightRecorder& ) = delete;
+
+        /**
+           truncates and maps the file at 'path' with a ring of 'size' bytes
+           and activates the recorder for the whole process, throws if the
+           file can not be mapped
+        */
+        void open( const std::string& path, const std::size_t size = DEFAULT_SIZE );
+
+        /**
+           deactivates and unmaps the recorder, the file is kept; records of
+           other threads have to be finished
+        */
+        void close( void );
+
+        const std::string& path( void ) const;
+
+        /**
+           per-process path in the temporary directory
+        */
+        static std::string temporary( void );
+
+        /**
+           'true' if a recorder is active
+        */
+        static u1 enabled( void );
+
+        /**
+           appends a record to the active recorder, records larger than a
+           quarter of the ring are truncated
+        */
+        static void record(
+            const Kind kind, const char* data, const std::size_t size, const u64 value = 0 );
+
+        static void record( const Kind kind, const std::string& data, const u64 value = 0 );
+
+        /**
+           writes the readable records of a recorder file to 'output' in the
+           order they were recorded, returns the amount of decoded records and
+           throws if the file is not a recorder file
+        */
+        static std::size_t decode( const std::string& path, std::ostream& output );
+
+      private:
+        struct Header;
+
+        void append( const Kind kind, const char* data, std::size_t size, const u64 value );
+
+        void copy( const u64 position, const void* data, const std::size_t size );
+
+      private:
+        std::string m_path;
+        Header* m_header;
+        char* m_ring;
+        u64 m_capacity;
+        std::size_t m_mapped;
+    };
+}
+
+#endif  // _CASMD_FLIGHT_RECORDER_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,142 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Frame.h"
+
+#include <cstring>
+
+using namespace casmd;
+using namespace libstdhl;
+using namespace Network;
+using namespace LSP;
+
+static constexpr const char* HEADER_PREFIX = "Content-Length: ";
+static constexpr const char* HEADER_SUFFIX = "\r\n\r\n";
+
+// prefix, at most 20 digits of the length and the suffix
+static constexpr std::size_t HEADER_CAPACITY = 16 + 20 + 4;
+
+Frame Frame::notification( const char* method, const Writer& params, const std::string& key )
+{
+    Frame frame;
+    frame.m_key = key;
+    JsonWriter json( frame.m_buffer );
+    json.beginObject();
+    json.key( "jsonrpc" ).string( "2.0", 3 );
+    json.key( "method" ).string( method, std::strlen( method ) );
+    json.key( "params" );
+    params( json );
+    json.endObject();
+    frame.seal();
+    return frame;
+}
+
+Frame Frame::response( const std::string& id, const Writer& result )
+{
+    Frame frame;
+    JsonWriter json( frame.m_buffer );
+    json.beginObject();
+    json.key( "jsonrpc" ).string( "2.0", 3 );
+    json.key( "id" ).raw( id );
+    json.key( "result" );
+    result( json );
+    json.endObject();
+    frame.seal();
+    return frame;
+}
+
+Frame Frame::error( const std::string& id, const i64 code, const std::string& message )
+{
+    Frame frame;
+    JsonWriter json( frame.m_buffer );
+    json.beginObject();
+    json.key( "jsonrpc" ).string( "2.0", 3 );
+    json.key( "id" ).raw( id );
+    json.key( "error" ).beginObject();
+    json.key( "code" ).number( code );
+    json.key( "message" ).string( message );
+    json.endObject();
+    json.endObject();
+    frame.seal();
+    return frame;
+}
+
+Frame Frame::message( const Message& message )
+{
+    Frame frame;
+    frame.m_buffer += message.dump();
+    frame.seal();
+    return frame;
+}
+
+Frame::Frame( void )
+: m_buffer( HEADER_CAPACITY, ' ' )
+, m_offset( 0 )
+, m_key()
+{
+}
+
+const char* Frame::data( void ) const
+{
+    return m_buffer.data() + m_offset;
+}
+
+std::size_t Frame::size( void ) const
+{
+    return m_buffer.size() - m_offset;
+}
+
+std::string Frame::payload( void ) const
+{
+    return m_buffer.substr( HEADER_CAPACITY );
+}
+
+const std::string& Frame::key( void ) const
+{
+    return m_key;
+}
+
+void Frame::seal( void )
+{
+    const auto length = std::to_string( m_buffer.size() - HEADER_CAPACITY );
+    const auto prefix = std::strlen( HEADER_PREFIX );
+    const auto suffix = std::strlen( HEADER_SUFFIX );
+
+    // the header is right-aligned to the payload inside the reserved room
+    m_offset = HEADER_CAPACITY - ( prefix + length.size() + suffix );
+
+    auto header = &m_buffer[ m_offset ];
+    std::memcpy( header, HEADER_PREFIX, prefix );
+    std::memcpy( header + prefix, length.data(), length.size() );
+    std::memcpy( header + prefix + length.size(), HEADER_SUFFIX, suffix );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,99 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_FRAME_H_
+#define _CASMD_FRAME_H_
+
+/**
+   @brief    serialized outbound LSP message incl. its header
+
+   A frame reserves room for the 'Content-Length' header in front of its
+   payload.  The payload is streamed directly into the frame buffer and the
+   header is placed right before it once the length is known, therefore the
+   complete frame is one contiguous buffer without any copy of the payload.
+*/
+
+#include "JsonWriter.h"
+
+#include <libstdhl/net/lsp/LSP>
+
+#include <functional>
+#include <string>
+
+namespace casmd
+{
+    class Frame
+    {
+      public:
+        using Writer = std::function< void( JsonWriter& ) >;
+
+        static Frame notification(
+            const char* method, const Writer& params, const std::string& key = "" );
+
+        static Frame response( const std::string& id, const Writer& result );
+
+        static Frame error( const std::string& id, const i64 code, const std::string& message );
+
+        /**
+           fallback for messages which are only available as JSON document
+        */
+        static Frame message( const libstdhl::Network::LSP::Message& message );
+
+        Frame( void );
+
+        const char* data( void ) const;
+
+        std::size_t size( void ) const;
+
+        /**
+           JSON payload without the header
+        */
+        std::string payload( void ) const;
+
+        /**
+           frames with the same non-empty key supersede each other, e.g. the
+           diagnostics notifications of a document
+        */
+        const std::string& key( void ) const;
+
+      private:
+        void seal( void );
+
+      private:
+        std::string m_buffer;
+        std::size_t m_offset;
+        std::string m_key;
+    };
+}
+
+#endif  // _CASMD_FRAME_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,352 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Interface.h"
+
+#include "Batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace casmd;
+
+static constexpr u64 FNV_OFFSET = 14695981039346656037ull;
+static constexpr u64 FNV_PRIME = 1099511628211ull;
+
+// sorted keywords of the CASM grammar
+static const char* KEYWORDS[] = {
+    "CASM", "and", "as", "behavior", "case", "choose", "default", "defined", "derived", "do",
+    "else", "endpar", "endseq", "enumeration", "exists", "false", "for", "forall", "function",
+    "holds", "if", "implement", "implies", "import", "in", "init", "initially", "invariant",
+    "iterate", "let", "local", "not", "of", "or", "par", "rule", "seq", "skip", "structure", "then",
+    "this", "true", "undef", "using", "while", "with", "xor",
+};
+
+namespace
+{
+    struct Token
+    {
+        std::string text;
+        libstdhl::u1 newline;  // token is the first one of its line
+        std::size_t line;
+        std::size_t column;  // in bytes
+    };
+
+    inline libstdhl::u1 isIdentifierStart( const char c )
+    {
+        return ( c >= 'a' and c <= 'z' ) or ( c >= 'A' and c <= 'Z' ) or c == '_';
+    }
+
+    inline libstdhl::u1 isIdentifierPart( const char c )
+    {
+        return isIdentifierStart( c ) or ( c >= '0' and c <= '9' );
+    }
+
+    /**
+       splits the text into tokens, whitespace and comments are dropped
+    */
+    std::vector< Token > tokenize( const std::string& text )
+    {
+        static const char* OPERATORS[] = { "::", "->", "=>", ":=", "!=", "<=", ">=" };
+
+        std::vector< Token > tokens;
+        const auto size = text.size();
+        std::size_t position = 0;
+        std::size_t line = 0;
+        std::size_t begin = 0;  // position of the current line
+        libstdhl::u1 newline = true;
+
+        while( position < size )
+        {
+            const auto c = text[ position ];
+            const auto start = position;
+
+            if( c == '\n' )
+            {
+                newline = true;
+                position++;
+                line++;
+                begin = position;
+                continue;
+            }
+            else if( c == ' ' or c == '\t' or c == '\r' )
+            {
+                position++;
+                continue;
+            }
+            else if( c == '/' and position + 1 < size and text[ position + 1 ] == '/' )
+            {
+                position = text.find( '\n', position );
+                position = position == std::string::npos ? size : position;
+                continue;
+            }
+            else if( c == '/' and position + 1 < size and text[ position + 1 ] == '*' )
+            {
+                const auto end = text.find( "*/", position + 2 );
+                const auto stop = end == std::string::npos ? size : end + 2;
+                for( ; position < stop; position++ )
+                {
+                    if( text[ position ] == '\n' )
+                    {
+                        newline = true;
+                        line++;
+                        begin = position + 1;
+                    }
+                }
+                continue;
+            }
+            else if( c == '"' )
+            {
+                position++;
+                while( position < size and text[ position ] != '"' and text[ position ] != '\n' )
+                {
+                    position += ( text[ position ] == '\\' ) ? 2 : 1;
+                }
+                position = std::min( position + 1, size );
+            }
+            else if( isIdentifierPart( c ) )
+            {
+                while( position < size and isIdentifierPart( text[ position ] ) )
+                {
+                    position++;
+                }
+            }
+            else
+            {
+                position++;
+                for( const auto op : OPERATORS )
+                {
+                    if( text.compare( start, 2, op ) == 0 )
+                    {
+                        position = start + 2;
+                        break;
+                    }
+                }
+            }
+
+            tokens.push_back(
+                { text.substr( start, position - start ), newline, line, start - begin } );
+            newline = false;
+        }
+
+        return tokens;
+    }
+
+    void hash( u64& fingerprint, const std::string& text )
+    {
+        for( const auto c : text )
+        {
+            fingerprint = ( fingerprint ^ static_cast< unsigned char >( c ) ) * FNV_PRIME;
+        }
+
+        // separator, 'a b' and 'ab' differ
+        fingerprint = ( fingerprint ^ ' ' ) * FNV_PRIME;
+    }
+}
+
+Interface::Interface( void )
+: m_imports()
+, m_fingerprint( FNV_OFFSET )
+, m_deterministic( true )
+, m_behavior( FNV_OFFSET )
+{
+}
+
+Interface Interface::scan( const std::string& text, const std::string& uri )
+{
+    Interface result;
+
+    const auto separator = uri.rfind( '/' );
+    const auto directory = separator == std::string::npos ? "" : uri.substr( 0, separator + 1 );
+
+    const auto tokens = tokenize( text );
+    const auto count = tokens.size();
+    std::size_t index = 0;
+
+    for( std::size_t position = 0; position < count; position++ )
+    {
+        if( tokens[ position ].text == "initially" and position + 1 < count and
+            tokens[ position + 1 ].text == "{" )
+        {
+            // the initializer block is skipped
+            std::size_t depth = 0;
+            for( position++; position < count; position++ )
+            {
+                const auto& text = tokens[ position ].text;
+                depth += text == "{" ? 1 : 0;
+                depth -= text == "}" ? 1 : 0;
+                if( depth == 0 )
+                {
+                    break;
+                }
+            }
+            continue;
+        }
+
+        hash( result.m_behavior, tokens[ position ].text );
+    }
+
+    while( index < count )
+    {
+        const auto& keyword = tokens[ index ].text;
+        index++;
+
+        // choose rules and expressions select an arbitrary value, and an
+        // initializer block defines several agents whose steps the
+        // scheduler may select in any order
+        if( keyword == "choose" or
+            ( keyword == "init" and index < count and tokens[ index ].text == "{" ) )
+        {
+            result.m_deterministic = false;
+            continue;
+        }
+
+        if( keyword == "import" )
+        {
+            std::vector< std::string > segments;
+            while( index < count and isIdentifierStart( tokens[ index ].text[ 0 ] ) and
+                   not Interface::keyword(
+                       tokens[ index ].text.data(), tokens[ index ].text.size() ) )
+            {
+                segments.emplace_back( tokens[ index ].text );
+                index++;
+                if( index >= count or tokens[ index ].text != "::" )
+                {
+                    break;
+                }
+                index++;
+            }
+
+            std::string path = "";
+            for( std::size_t segment = 0; segment < segments.size(); segment++ )
+            {
+                path += ( segment == 0 ? "" : "/" ) + segments[ segment ];
+                if( segment + 2 >= segments.size() )
+                {
+                    result.m_imports.emplace_back( directory + path + Batch::EXTENSION );
+                }
+            }
+
+            hash( result.m_fingerprint, keyword );
+            hash( result.m_fingerprint, path );
+            continue;
+        }
+
+        const auto enumeration = keyword == "enumeration";
+        const auto signature = keyword == "function" or keyword == "using";
+        if( not( enumeration or signature or keyword == "derived" or keyword == "rule" or
+                 keyword == "invariant" or keyword == "structure" or keyword == "behavior" or
+                 keyword == "implement" ) )
+        {
+            continue;
+        }
+
+        // the header ends at the body, an enumeration includes its
+        // enumerators and signatures end at their line
+        hash( result.m_fingerprint, keyword );
+        while( index < count )
+        {
+            const auto& token = tokens[ index ];
+            if( signature and ( token.newline or token.text == "initially" or
+                                token.text == "defined" ) )
+            {
+                break;
+            }
+            if( not enumeration and not signature and ( token.text == "=" or token.text == "{" ) )
+            {
+                break;
+            }
+
+            hash( result.m_fingerprint, token.text );
+            index++;
+
+            if( enumeration and token.text == "}" )
+            {
+                break;
+            }
+        }
+    }
+
+    std::sort( result.m_imports.begin(), result.m_imports.end() );
+    result.m_imports.erase(
+        std::unique( result.m_imports.begin(), result.m_imports.end() ),
+        result.m_imports.end() );
+
+    return result;
+}
+
+const std::vector< std::string >& Interface::imports( void ) const
+{
+    return m_imports;
+}
+
+u64 Interface::fingerprint( void ) const
+{
+    return m_fingerprint;
+}
+
+u1 Interface::deterministic( void ) const
+{
+    return m_deterministic;
+}
+
+u64 Interface::behavior( void ) const
+{
+    return m_behavior;
+}
+
+u1 Interface::keyword( const char* begin, const std::size_t length )
+{
+    const auto end = std::end( KEYWORDS );
+    const auto it = std::lower_bound(
+        std::begin( KEYWORDS ), end, std::make_pair( begin, length ),
+        []( const char* entry, const std::pair< const char*, std::size_t >& word ) {
+            const auto size = std::strlen( entry );
+            const auto result = std::strncmp( entry, word.first, std::min( size, word.second ) );
+            return result < 0 or ( result == 0 and size < word.second );
+        } );
+
+    return it != end and std::strlen( *it ) == length and std::strncmp( *it, begin, length ) == 0;
+}
+
+std::string Interface::normalize( const std::string& text )
+{
+    std::string normalized = "";
+    for( const auto& token : tokenize( text ) )
+    {
+        // a string token contains no line break
+        normalized += std::to_string( token.line ) + ":" + std::to_string( token.column ) + " " +
+                      token.text + "\n";
+    }
+    return normalized;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,113 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_INTERFACE_H_
+#define _CASMD_INTERFACE_H_
+
+/**
+   @brief    imports and interface fingerprint of a specification
+
+   The interface of a specification consists of the headers of its
+   definitions, e.g. the name and signature of a function or the parameters
+   of a rule, but not their bodies.  The fingerprint is a hash of the
+   normalized header tokens, therefore edits of comments, whitespace or
+   rule bodies do not change it.  The same scan also detects whether the
+   specification is deterministic and derives a fingerprint of all tokens
+   but the initial values.
+*/
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u64 = libstdhl::u64;
+
+    class Interface
+    {
+      public:
+        /**
+           scans the text of the specification 'uri', imports are resolved to
+           URIs relative to the directory of 'uri'
+        */
+        static Interface scan( const std::string& text, const std::string& uri );
+
+        /**
+           URIs of the imported specifications, an import path 'a::b' yields
+           the candidates 'a/b.casm' and 'a.casm' because the last segment
+           may name a symbol of the module
+        */
+        const std::vector< std::string >& imports( void ) const;
+
+        u64 fingerprint( void ) const;
+
+        /**
+           'false' if the specification uses a nondeterministic construct,
+           a 'choose' or an 'init' block of several agents
+        */
+        u1 deterministic( void ) const;
+
+        /**
+           hash of all tokens but the 'initially' values of functions, it
+           stays the same if only the initial state of the model changes
+        */
+        u64 behavior( void ) const;
+
+        /**
+           'true' if the word of 'length' bytes at 'begin' is a keyword of
+           the CASM grammar
+        */
+        static u1 keyword( const char* begin, const std::size_t length );
+
+        /**
+           tokens of 'text' with their positions, one per line.  It stays the
+           same for edits of comments and whitespace which move no token,
+           therefore results which refer to source positions stay valid
+        */
+        static std::string normalize( const std::string& text );
+
+      private:
+        Interface( void );
+
+      private:
+        std::vector< std::string > m_imports;
+        u64 m_fingerprint;
+        u1 m_deterministic;
+        u64 m_behavior;
+    };
+}
+
+#endif  // _CASMD_INTERFACE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
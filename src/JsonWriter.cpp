@@ -0,0 +1,234 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "JsonWriter.h"
+
+using namespace casmd;
+
+static constexpr const char* HEX = "0123456789abcdef";
+
+JsonWriter::JsonWriter( std::string& buffer )
+: m_buffer( buffer )
+, m_first()
+, m_member( false )
+{
+    m_first.reserve( 16 );
+}
+
+JsonWriter& JsonWriter::beginObject( void )
+{
+    separate();
+    m_buffer += '{';
+    m_first.emplace_back( true );
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject( void )
+{
+    m_buffer += '}';
+    m_first.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray( void )
+{
+    separate();
+    m_buffer += '[';
+    m_first.emplace_back( true );
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray( void )
+{
+    m_buffer += ']';
+    m_first.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key( const char* name )
+{
+    separate();
+    m_buffer += '"';
+    m_buffer += name;
+    m_buffer += "\":";
+    m_member = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key( const std::string& name )
+{
+    separate();
+    escape( name.data(), name.size() );
+    m_buffer += ':';
+    m_member = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string( const std::string& value )
+{
+    return string( value.data(), value.size() );
+}
+
+JsonWriter& JsonWriter::string( const char* value, const std::size_t length )
+{
+    separate();
+    escape( value, length );
+    return *this;
+}
+
+void JsonWriter::escape( const char* value, const std::size_t length )
+{
+    m_buffer += '"';
+
+    // append runs of characters which need no escaping at once
+    std::size_t run = 0;
+    for( std::size_t i = 0; i < length; i++ )
+    {
+        const auto c = static_cast< unsigned char >( value[ i ] );
+        if( c >= 0x20 and c != '"' and c != '\\' )
+        {
+            continue;
+        }
+
+        m_buffer.append( value + run, i - run );
+        run = i + 1;
+
+        switch( c )
+        {
+            case '"':
+            {
+                m_buffer += "\\\"";
+                break;
+            }
+            case '\\':
+            {
+                m_buffer += "\\\\";
+                break;
+            }
+            case '\n':
+            {
+                m_buffer += "\\n";
+                break;
+            }
+            case '\r':
+            {
+                m_buffer += "\\r";
+                break;
+            }
+            case '\t':
+            {
+                m_buffer += "\\t";
+                break;
+            }
+            default:
+            {
+                const char escape[] = { '\\', 'u', '0', '0', HEX[ c >> 4 ], HEX[ c & 0xf ] };
+                m_buffer.append( escape, sizeof( escape ) );
+                break;
+            }
+        }
+    }
+
+    m_buffer.append( value + run, length - run );
+    m_buffer += '"';
+}
+
+JsonWriter& JsonWriter::number( const i64 value )
+{
+    separate();
+
+    char digits[ 24 ];
+    char* end = digits + sizeof( digits );
+    char* begin = end;
+
+    // negate in unsigned arithmetic to support the minimum value as well
+    u64 magnitude = value < 0 ? 0 - static_cast< u64 >( value ) : static_cast< u64 >( value );
+    do
+    {
+        *( --begin ) = static_cast< char >( '0' + ( magnitude % 10 ) );
+        magnitude /= 10;
+    } while( magnitude > 0 );
+
+    if( value < 0 )
+    {
+        *( --begin ) = '-';
+    }
+
+    m_buffer.append( begin, end - begin );
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean( const u1 value )
+{
+    separate();
+    m_buffer += ( value ? "true" : "false" );
+    return *this;
+}
+
+JsonWriter& JsonWriter::null( void )
+{
+    separate();
+    m_buffer += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw( const std::string& json )
+{
+    separate();
+    m_buffer += json;
+    return *this;
+}
+
+void JsonWriter::separate( void )
+{
+    if( m_member )
+    {
+        // value of an object member, the key already placed the separator
+        m_member = false;
+        return;
+    }
+
+    if( m_first.empty() )
+    {
+        return;
+    }
+
+    if( m_first.back() )
+    {
+        m_first.back() = false;
+    }
+    else
+    {
+        m_buffer += ',';
+    }
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,106 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_JSON_WRITER_H_
+#define _CASMD_JSON_WRITER_H_
+
+/**
+   @brief    streaming JSON serializer
+
+   Appends JSON text directly to a string buffer without building an
+   intermediate JSON document.  Separators between object members and array
+   elements are inserted automatically.
+*/
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using i64 = libstdhl::i64;
+    using u64 = libstdhl::u64;
+
+    class JsonWriter
+    {
+      public:
+        JsonWriter( std::string& buffer );
+
+        JsonWriter& beginObject( void );
+
+        JsonWriter& endObject( void );
+
+        JsonWriter& beginArray( void );
+
+        JsonWriter& endArray( void );
+
+        /**
+           'name' is written as is, it must not need any escaping
+        */
+        JsonWriter& key( const char* name );
+
+        /**
+           escapes 'name' like a string value, e.g. a document URI as key
+        */
+        JsonWriter& key( const std::string& name );
+
+        JsonWriter& string( const std::string& value );
+
+        JsonWriter& string( const char* value, const std::size_t length );
+
+        JsonWriter& number( const i64 value );
+
+        JsonWriter& boolean( const u1 value );
+
+        JsonWriter& null( void );
+
+        /**
+           appends an already serialized JSON value
+        */
+        JsonWriter& raw( const std::string& json );
+
+      private:
+        void separate( void );
+
+        void escape( const char* value, const std::size_t length );
+
+      private:
+        std::string& m_buffer;
+        std::vector< u1 > m_first;
+        u1 m_member;
+    };
+}
+
+#endif  // _CASMD_JSON_WRITER_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -23,20 +23,28 @@
 
 #include "LanguageServer.h"
 
-#include "DiagnosticFormatter.h"
+#include "Analysis.h"
+#include "Batch.h"
+#include "Execution.h"
+#include "FlightRecorder.h"
+#include "Interface.h"
+#include "LineIndex.h"
+#include "SemanticTokens.h"
 #include "casmd/Version"
 
-#include <libcasm-fe/analyze/ConsistencyCheckPass>
-#include <libcasm-fe/execute/NumericExecutionPass>
-#include <libcasm-fe/execute/SymbolicExecutionPass>
 #include <libpass/PassManager>
 #include <libpass/PassResult>
 #include <libpass/analyze/LoadFilePass>
 #include <libstdhl/String>
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
 #include <thread>
+#include <unordered_set>
 
 using namespace casmd;
 using namespace libpass;
@@ -44,30 +52,503 @@ using namespace libstdhl;
 using namespace Network;
 using namespace LSP;
 
+// steps between two snapshots of a 'run', and the amount of snapshots kept
+// per document
+static constexpr u64 SNAPSHOT_INTERVAL = 10000;
+static constexpr std::size_t SNAPSHOTS = 4;
+
+static void occurrenceRange( JsonWriter& json, const OccurrenceIndex::Occurrence& occurrence )
+{
+    json.beginObject();
+    json.key( "start" ).beginObject();
+    json.key( "line" ).number( occurrence.line );
+    json.key( "character" ).number( occurrence.character );
+    json.endObject();
+    json.key( "end" ).beginObject();
+    json.key( "line" ).number( occurrence.line );
+    json.key( "character" ).number( occurrence.character + occurrence.length );
+    json.endObject();
+    json.endObject();
+}
+
+/**
+   result of a 'run' which selected a backend or snapshots, or of a 'resume':
+   the output together with the backend which executed it and the reason of
+   a fallback to the AST interpreter
+*/
+static void executionResult(
+    JsonWriter& json,
+    const std::string& output,
+    const Execution::Backend backend,
+    const std::string& fallback )
+{
+    json.beginObject();
+    json.key( "output" ).string( output );
+    json.key( "backend" );
+    switch( backend )
+    {
+        case Execution::Backend::AST:
+        {
+            json.string( "ast", 3 );
+            break;
+        }
+        case Execution::Backend::FLAT:
+        {
+            json.string( "flat", 4 );
+            break;
+        }
+        case Execution::Backend::PARALLEL:
+        {
+            json.string( "parallel", 8 );
+            break;
+        }
+    }
+    json.key( "fallback" );
+    if( fallback.empty() )
+    {
+        json.null();
+    }
+    else
+    {
+        json.string( fallback );
+    }
+    json.endObject();
+}
+
+/**
+   documents of the occurrences in the order of their URIs
+*/
+static std::vector< OccurrenceIndex::Occurrences::const_pointer > sortedOccurrences(
+    const OccurrenceIndex::Occurrences& occurrences )
+{
+    std::vector< OccurrenceIndex::Occurrences::const_pointer > documents;
+    for( const auto& document : occurrences )
+    {
+        documents.push_back( &document );
+    }
+
+    std::sort(
+        documents.begin(),
+        documents.end(),
+        []( OccurrenceIndex::Occurrences::const_pointer lhs,
+            OccurrenceIndex::Occurrences::const_pointer rhs ) { return lhs->first < rhs->first; } );
+    return documents;
+}
+
 //
 //
 // LanguageServer
 //
 
-LanguageServer::LanguageServer( Logger& log )
+LanguageServer::LanguageServer(
+    Logger& log, const std::size_t budget, const std::size_t workers )
 : Server()
 , m_log( log )
-, m_files()
+, m_workspace( budget )
+, m_frames()
+, m_tokensResultId( 0 )
+, m_dependencies()
+, m_occurrences()
+, m_pool( workers )
+, m_results()
+, m_traces()
+, m_refreshId( 0 )
+, m_scheduler( nullptr )
+, m_handler()
 {
     m_log.info( "started LSP" );
 }
 
+u1 LanguageServer::dispatch( const Message& request )
+{
+    if( request.find( "id" ) == request.end() or request.find( "method" ) == request.end() )
+    {
+        return false;
+    }
+
+    const std::string method = request[ "method" ];
+    const auto id = request[ "id" ].dump();
+
+    try
+    {
+        switch( String::value( method ) )
+        {
+            case String::value( "workspace/executeCommand" ):
+            {
+                const ExecuteCommandParams params( request[ "params" ] );
+                const auto& command = params.command();
+                if( command != "run" and command != "trace" and command != "profile" and
+                    command != "resume" )
+                {
+                    return false;
+                }
+
+                m_log.info( "workspace_executeCommand" );
+                DocumentUri fileuri = DocumentUri::fromString( "inmemory://model.casm" );
+                const auto& raw = request[ "params" ];
+                const auto arguments =
+                    raw.find( "arguments" ) != raw.end() ? raw[ "arguments" ].dump() : "[]";
+
+                std::string output = "";
+                std::string fallback = "";
+                auto executor = Execution::Backend::AST;
+                auto structured = false;
+                if( command == "profile" )
+                {
+                    // the code lenses pass the profiled document as argument
+                    if( raw.find( "arguments" ) != raw.end() and raw[ "arguments" ].size() > 0 )
+                    {
+                        const auto& argument = raw[ "arguments" ][ 0 ];
+                        fileuri = DocumentUri::fromString( argument.get< std::string >() );
+                    }
+                    output = textDocument_profile( fileuri );
+                }
+                else if( command == "resume" )
+                {
+                    // an optional step selects the latest snapshot up to it
+                    u64 step = std::numeric_limits< u64 >::max();
+                    if( raw.find( "arguments" ) != raw.end() and raw[ "arguments" ].size() > 0 )
+                    {
+                        step = raw[ "arguments" ][ 0 ].get< u64 >();
+                    }
+                    output = textDocument_resume( fileuri, step, fallback );
+                    executor = fallback.empty() ? Execution::Backend::FLAT
+                                                : Execution::Backend::AST;
+                    structured = true;
+                }
+                else
+                {
+                    // 'run' takes the backend ("ast", "flat" or "parallel")
+                    // and "snapshots" as optional arguments, snapshots run on
+                    // the flat backend.  The AST interpreter is the default
+                    auto backend = Execution::Backend::AST;
+                    auto snapshots = false;
+                    if( command == "run" and raw.find( "arguments" ) != raw.end() )
+                    {
+                        for( const auto& argument : raw[ "arguments" ] )
+                        {
+                            if( not argument.is_string() )
+                            {
+                                continue;
+                            }
+
+                            const auto name = argument.get< std::string >();
+                            if( name == "flat" )
+                            {
+                                backend = Execution::Backend::FLAT;
+                            }
+                            else if( name == "parallel" )
+                            {
+                                backend = Execution::Backend::PARALLEL;
+                            }
+                            else if( name == "snapshots" )
+                            {
+                                snapshots = true;
+                            }
+                            else if( name != "ast" )
+                            {
+                                continue;
+                            }
+                            structured = true;
+                        }
+                    }
+
+                    output = textDocument_execute(
+                        fileuri, command == "trace", arguments, backend, snapshots, fallback );
+                    if( fallback.empty() and backend != Execution::Backend::AST )
+                    {
+                        executor = backend;
+                    }
+                    else if( fallback.empty() and snapshots )
+                    {
+                        executor = Execution::Backend::FLAT;
+                    }
+                }
+                m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+                    if( structured )
+                    {
+                        executionResult( json, output, executor, fallback );
+                    }
+                    else
+                    {
+                        json.string( output );
+                    }
+                } ) );
+                return true;
+            }
+            case String::value( "textDocument/hover" ):
+            {
+                m_log.info( "textDocument_hover" );
+                const HoverParams params( request[ "params" ] );
+                const auto& position = params.position();
+                const auto contents = textDocument_hoverContents(
+                    params.textDocument().uri(), position.line(), position.character() );
+
+                m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+                    if( contents.empty() )
+                    {
+                        json.null();
+                        return;
+                    }
+
+                    json.beginObject();
+                    json.key( "contents" ).beginObject();
+                    json.key( "kind" ).string( "plaintext", 9 );
+                    json.key( "value" ).string( contents );
+                    json.endObject();
+                    json.endObject();
+                } ) );
+                return true;
+            }
+            case String::value( "textDocument/documentSymbol" ):
+            {
+                m_log.info( "textDocument_documentSymbol" );
+                const TextDocumentIdentifier textDocument( request[ "params" ][ "textDocument" ] );
+                const auto& outline = textDocument_outline( textDocument.uri() );
+                m_frames.emplace_back( Frame::response(
+                    id, [&]( JsonWriter& json ) { json.raw( outline.symbols() ); } ) );
+                return true;
+            }
+            case String::value( "textDocument/references" ):
+            {
+                m_log.info( "textDocument_references" );
+                const auto& params = request[ "params" ];
+                const TextDocumentIdentifier textDocument( params[ "textDocument" ] );
+                const auto& position = params[ "position" ];
+                u1 includeDeclaration = false;
+                if( params.find( "context" ) != params.end() )
+                {
+                    includeDeclaration = params[ "context" ][ "includeDeclaration" ].get< u1 >();
+                }
+
+                std::string name = "";
+                const auto references = textDocument_references(
+                    textDocument.uri(),
+                    position[ "line" ].get< u32 >(),
+                    position[ "character" ].get< u32 >(),
+                    name );
+
+                m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+                    json.beginArray();
+                    for( const auto document : sortedOccurrences( references ) )
+                    {
+                        for( const auto& occurrence : document->second )
+                        {
+                            if( occurrence.declaration and not includeDeclaration )
+                            {
+                                continue;
+                            }
+
+                            json.beginObject();
+                            json.key( "uri" ).string( document->first );
+                            json.key( "range" );
+                            occurrenceRange( json, occurrence );
+                            json.endObject();
+                        }
+                    }
+                    json.endArray();
+                } ) );
+                return true;
+            }
+            case String::value( "textDocument/documentHighlight" ):
+            {
+                m_log.info( "textDocument_documentHighlight" );
+                const auto& params = request[ "params" ];
+                const TextDocumentIdentifier textDocument( params[ "textDocument" ] );
+                const auto& position = params[ "position" ];
+
+                std::string name = "";
+                const auto references = textDocument_references(
+                    textDocument.uri(),
+                    position[ "line" ].get< u32 >(),
+                    position[ "character" ].get< u32 >(),
+                    name );
+                const auto occurrences = references.find( textDocument.uri().toString() );
+
+                m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+                    json.beginArray();
+                    if( occurrences != references.end() )
+                    {
+                        for( const auto& occurrence : occurrences->second )
+                        {
+                            // 'DocumentHighlightKind' text for the declaration
+                            // and read for its uses
+                            json.beginObject();
+                            json.key( "range" );
+                            occurrenceRange( json, occurrence );
+                            json.key( "kind" ).number( occurrence.declaration ? 1 : 2 );
+                            json.endObject();
+                        }
+                    }
+                    json.endArray();
+                } ) );
+                return true;
+            }
+            case String::value( "textDocument/rename" ):
+            {
+                m_log.info( "textDocument_rename" );
+                const auto& params = request[ "params" ];
+                const TextDocumentIdentifier textDocument( params[ "textDocument" ] );
+                const auto& position = params[ "position" ];
+                const std::string newName = params[ "newName" ];
+
+                std::string name = "";
+                const auto references = textDocument_references(
+                    textDocument.uri(),
+                    position[ "line" ].get< u32 >(),
+                    position[ "character" ].get< u32 >(),
+                    name );
+
+                if( not name.empty() )
+                {
+                    if( not OccurrenceIndex::identifier( newName ) )
+                    {
+                        throw std::invalid_argument( "'" + newName + "' is not an identifier" );
+                    }
+
+                    const auto existing = m_occurrences.references(
+                        textDocument.uri().toString(), newName, m_dependencies );
+                    for( const auto& document : existing )
+                    {
+                        for( const auto& occurrence : document.second )
+                        {
+                            if( occurrence.declaration )
+                            {
+                                throw std::invalid_argument(
+                                    "'" + newName + "' is already declared in '" +
+                                    document.first + "'" );
+                            }
+                        }
+                    }
+                }
+
+                m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+                    if( name.empty() )
+                    {
+                        json.null();
+                        return;
+                    }
+
+                    json.beginObject();
+                    json.key( "changes" ).beginObject();
+                    for( const auto document : sortedOccurrences( references ) )
+                    {
+                        json.key( document->first ).beginArray();
+                        for( const auto& occurrence : document->second )
+                        {
+                            json.beginObject();
+                            json.key( "range" );
+                            occurrenceRange( json, occurrence );
+                            json.key( "newText" ).string( newName );
+                            json.endObject();
+                        }
+                        json.endArray();
+                    }
+                    json.endObject();
+                    json.endObject();
+                } ) );
+                return true;
+            }
+            case String::value( "textDocument/codeLens" ):
+            {
+                m_log.info( "textDocument_codeLens" );
+                const TextDocumentIdentifier textDocument( request[ "params" ][ "textDocument" ] );
+                const auto& lenses = textDocument_lenses( textDocument.uri() );
+                m_frames.emplace_back(
+                    Frame::response( id, [&]( JsonWriter& json ) { json.raw( lenses ); } ) );
+                return true;
+            }
+            case String::value( "textDocument/foldingRange" ):
+            {
+                m_log.info( "textDocument_foldingRange" );
+                const TextDocumentIdentifier textDocument( request[ "params" ][ "textDocument" ] );
+                const auto& outline = textDocument_outline( textDocument.uri() );
+                m_frames.emplace_back( Frame::response(
+                    id, [&]( JsonWriter& json ) { json.raw( outline.foldingRanges() ); } ) );
+                return true;
+            }
+            case String::value( "textDocument/diagnostic" ):
+            {
+                m_log.info( "textDocument_diagnostic" );
+                const auto& params = request[ "params" ];
+                const TextDocumentIdentifier textDocument( params[ "textDocument" ] );
+                std::string previousResultId = "";
+                if( params.find( "previousResultId" ) != params.end() )
+                {
+                    previousResultId = params[ "previousResultId" ].get< std::string >();
+                }
+
+                const auto fileuri = textDocument.uri();
+                const auto document = textDocument_diagnostics( fileuri );
+                m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+                    diagnosticReport( json, *document, previousResultId );
+                } ) );
+                return true;
+            }
+            case String::value( "workspace/diagnostic" ):
+            {
+                m_log.info( "workspace_diagnostic" );
+                const auto& params = request[ "params" ];
+                std::unordered_map< std::string, std::string > previousResultIds;
+                for( const auto& previous : params[ "previousResultIds" ] )
+                {
+                    previousResultIds.emplace(
+                        previous[ "uri" ].get< std::string >(),
+                        previous[ "value" ].get< std::string >() );
+                }
+
+                workspace_diagnostic( id, previousResultIds );
+                return true;
+            }
+            case String::value( "textDocument/semanticTokens/full" ):
+            {
+                m_log.info( "textDocument_semanticTokens" );
+                const TextDocumentIdentifier textDocument( request[ "params" ][ "textDocument" ] );
+                textDocument_semanticTokens( id, textDocument.uri() );
+                return true;
+            }
+            case String::value( "textDocument/semanticTokens/full/delta" ):
+            {
+                m_log.info( "textDocument_semanticTokensDelta" );
+                const auto& params = request[ "params" ];
+                const TextDocumentIdentifier textDocument( params[ "textDocument" ] );
+                const std::string previousResultId = params[ "previousResultId" ];
+                textDocument_semanticTokens( id, textDocument.uri(), previousResultId );
+                return true;
+            }
+        }
+    }
+    catch( const std::exception& e )
+    {
+        m_log.error( e.what() );
+        m_frames.emplace_back( Frame::error( id, -32603, e.what() ) );
+        return true;
+    }
+
+    return false;
+}
+
+void LanguageServer::drain( const std::function< void( const Frame& ) >& callback )
+{
+    flush( [&]( const Message& message ) { callback( Frame::message( message ) ); } );
+
+    for( const auto& frame : m_frames )
+    {
+        callback( frame );
+    }
+    m_frames.clear();
+}
+
 InitializeResult LanguageServer::initialize( const InitializeParams& params )
 {
     m_log.info( __FUNCTION__ );
 
     ServerCapabilities sc;
 
-    // TextDocumentSyncOptions tdso;
-    // tdso.setChange( TextDocumentSyncKind::Full );
-    // tdso.setOpenClose( true );
-    // sc.setTextDocumentSync( tdso );
-    sc.setTextDocumentSync( TextDocumentSyncKind::Full );
+    TextDocumentSyncOptions tdso;
+    tdso.setChange( TextDocumentSyncKind::Incremental );
+    tdso.setOpenClose( true );
+    sc.setTextDocumentSync( tdso );
 
     CompletionOptions cp;
     // cp.setResolveProvider( false );
@@ -75,23 +556,41 @@ InitializeResult LanguageServer::initialize( const InitializeParams& params )
     sc.setCompletionProvider( cp );
 
     sc.setHoverProvider( true );
-    // sc.setDocumentSymbolProvider( true );
-    // sc.setReferencesProvider( true );
+    sc.setDocumentSymbolProvider( true );
+    sc.setReferencesProvider( true );
     // sc.setDefinitionProvider( true );
-    // sc.setDocumentHighlightProvider( true );
+    sc.setDocumentHighlightProvider( true );
     // sc.setCodeActionProvider( true );
-    // sc.setRenameProvider( true );
+    sc.setRenameProvider( true );
     // sc.setColorProvider( .. );
-    // sc.setFoldingRangeProvider( ... );
+    sc[ "foldingRangeProvider" ] = true;
+    sc[ "diagnosticProvider" ] =
+        Data::parse( "{\"interFileDependencies\":true,\"workspaceDiagnostics\":true}" );
 
     ExecuteCommandOptions eco;
     eco.addCommand( "version" );
     eco.addCommand( "run" );
     eco.addCommand( "trace" );
+    eco.addCommand( "memory" );
+    eco.addCommand( "queue" );
+    eco.addCommand( "profile" );
+    eco.addCommand( "resume" );
+    eco.addCommand( "snapshots" );
     sc.setExecuteCommandProvider( eco );
 
-    // CodeLensOptions clo;
-    // sc.setCodeLensProvider( clo );
+    std::string semanticTokens = "";
+    JsonWriter json( semanticTokens );
+    json.beginObject();
+    json.key( "legend" );
+    SemanticTokens::legend( json );
+    json.key( "range" ).boolean( false );
+    json.key( "full" ).beginObject();
+    json.key( "delta" ).boolean( true );
+    json.endObject();
+    json.endObject();
+    sc[ "semanticTokensProvider" ] = Data::parse( semanticTokens );
+
+    sc[ "codeLensProvider" ] = Data::parse( "{\"resolveProvider\":false}" );
 
     // TODO: FIXME: @ppaulweber: REMOVE this delay if LSP clients
     // (e.g. monaco, vscode etc.) can handle a really fast initialization
@@ -146,14 +645,29 @@ ExecuteCommandResult LanguageServer::workspace_executeCommand( const ExecuteComm
                    NOTICE;
         }
         case String::value( "run" ):
+        case String::value( "trace" ):
         {
             const DocumentUri fileuri = DocumentUri::fromString( "inmemory://model.casm" );
-            return textDocument_execute( fileuri );
+            std::string fallback = "";
+            return textDocument_execute(
+                fileuri, command == "trace", "[]", Execution::Backend::AST, false, fallback );
         }
-        case String::value( "trace" ):
+        case String::value( "profile" ):
         {
             const DocumentUri fileuri = DocumentUri::fromString( "inmemory://model.casm" );
-            return textDocument_execute( fileuri, true );
+            return textDocument_profile( fileuri );
+        }
+        case String::value( "memory" ):
+        {
+            return workspace_memory();
+        }
+        case String::value( "queue" ):
+        {
+            return workspace_queue();
+        }
+        case String::value( "snapshots" ):
+        {
+            return workspace_snapshots();
         }
     }
 
@@ -174,36 +688,89 @@ void LanguageServer::textDocument_didOpen( const DidOpenTextDocumentParams& para
     const auto& fileext = params.textDocument().languageId();
     const auto& filerev = params.textDocument().version();
 
-    auto result = m_files.emplace( fileuri.toString(), File::TextDocument{ fileuri, fileext } );
+    m_workspace.open( fileuri, fileext, filestr, filerev );
 
-    if( not result.second )
+    if( textDocument_analyze( fileuri ) )
     {
-        m_log.error( "text document '" + fileuri.toString() + "' already opened!" );
+        textDocument_analyzeDependents( fileuri );
+    }
+}
+
+void LanguageServer::textDocument_didChange( const DidChangeTextDocumentParams& params ) noexcept
+{
+    m_log.info( __FUNCTION__ );
+
+    const auto& fileuri = params.textDocument().uri();
+    const auto& filerev = params.textDocument().version();
+
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        m_log.error( "unable to find text document '" + fileuri.toString() + "'" );
         return;
     }
 
-    result.first->second.setData( filestr );
+    // the changes are applied in order, the range of a change refers to the
+    // text after the preceding ones, a change without range replaces the text
+    const auto& changes = params[ "contentChanges" ];
+    std::string text = document->file().data();
+    LineIndex lines = document->lines();
+    for( std::size_t index = 0; index < changes.size(); index++ )
+    {
+        const auto& change = changes[ index ];
+        if( change.find( "range" ) == change.end() )
+        {
+            text = change[ "text" ].get< std::string >();
+        }
+        else
+        {
+            const auto& range = change[ "range" ];
+            const auto start = lines.offset(
+                text,
+                { range[ "start" ][ "line" ].get< u32 >(),
+                  range[ "start" ][ "character" ].get< u32 >() } );
+            const auto end = lines.offset(
+                text,
+                { range[ "end" ][ "line" ].get< u32 >(),
+                  range[ "end" ][ "character" ].get< u32 >() } );
+            text.replace(
+                start, std::max( start, end ) - start, change[ "text" ].get< std::string >() );
+        }
 
-    textDocument_analyze( fileuri );
+        if( index + 1 < changes.size() )
+        {
+            lines = LineIndex( text );
+        }
+    }
+
+    document->setText( text, filerev );
+
+    if( textDocument_analyze( fileuri ) )
+    {
+        textDocument_analyzeDependents( fileuri );
+    }
 }
 
-void LanguageServer::textDocument_didChange( const DidChangeTextDocumentParams& params ) noexcept
+void LanguageServer::textDocument_didClose( const DidCloseTextDocumentParams& params ) noexcept
 {
     m_log.info( __FUNCTION__ );
 
     const auto& fileuri = params.textDocument().uri();
-    const auto& filerev = params.textDocument().version();
 
-    auto result = m_files.find( fileuri.toString() );
-    if( result == m_files.end() )
+    if( not m_workspace.close( fileuri ) )
     {
         m_log.error( "unable to find text document '" + fileuri.toString() + "'" );
         return;
     }
 
-    result->second.setData( params[ "contentChanges" ][ 0 ][ "text" ] );
+    m_dependencies.remove( fileuri.toString() );
+    m_occurrences.remove( fileuri.toString() );
+    m_snapshots.erase( fileuri.toString() );
 
-    textDocument_analyze( fileuri );
+    // clear the diagnostics of the closed document in the client
+    publishDiagnostics( fileuri, std::vector< casmd::Diagnostic >() );
+
+    m_workspace.enforce();
 }
 
 //
@@ -248,100 +815,858 @@ CodeLensResult LanguageServer::textDocument_codeLens( const CodeLensParams& para
 // LanguageServer (private)
 //
 
-void LanguageServer::textDocument_analyze( const DocumentUri& fileuri )
+u1 LanguageServer::textDocument_analyze( const DocumentUri& fileuri )
 {
-    auto result = m_files.find( fileuri.toString() );
-    if( result == m_files.end() )
+    auto document = m_workspace.find( fileuri );
+    if( not document )
     {
         m_log.error( "unable to find text document '" + fileuri.toString() + "'" );
-        return;
+        return false;
     }
 
-    auto& file = result->second;
+    auto& file = document->file();
 
     m_log.info(
         std::to_string( (u64)&file ) + " ... " + fileuri.toString() + "\n\n" + file.data() );
 
-    // file is already in-memory, by-pass the LoadFilePass by setting its pass result
-    PassResult pr;
-    pr.setOutput< LoadFilePass >( file );
+    Analysis analysis( file );
+    {
+        FlightRecorder::Span span( "analysis", fileuri.toString() );
+        analysis.run( std::cerr );
+    }
 
-    PassManager pm;
-    pm.setDefaultResult( pr );
-    pm.setDefaultPass< libcasm_fe::ConsistencyCheckPass >();
+    const auto changed = textDocument_analyzed( *document, analysis );
+    m_workspace.enforce();
+    return changed;
+}
 
-    try
+u1 LanguageServer::textDocument_analyzed( Document& document, const Analysis& analysis )
+{
+    if( not analysis.error().empty() )
     {
-        pm.run();
+        m_log.error( analysis.error() );
     }
-    catch( const std::exception& e )
+
+    document.setAnalysis( analysis.result(), analysis.diagnostics(), analysis.footprint() );
+    publishDiagnostics( document.uri(), document.serializedDiagnostics() );
+
+    // the symbols of the revision replace the previous ones in the index
+    const auto uri = document.uri().toString();
+    const auto& text = document.file().data();
+    const auto& lines = document.lines();
+    m_occurrences.update(
+        uri, text, lines, SemanticTokens::collect( text, lines, analysis.result() ) );
+
+    return m_dependencies.update( uri, Interface::scan( text, uri ) );
+}
+
+void LanguageServer::textDocument_analyzeDependents( const DocumentUri& fileuri )
+{
+    std::unordered_set< std::string > changed = { fileuri.toString() };
+
+    for( const auto& level : m_dependencies.dependents( fileuri.toString() ) )
     {
-        m_log.error( "pass manager triggered an exception: '" + std::string( e.what() ) + "'" );
-    }
+        // the documents of a level are collected after yielding, a served
+        // request may evict or re-analyze them
+        yield( Scheduler::Priority::ANALYSIS );
+
+        // dependents whose imported interfaces did not change are skipped
+        std::vector< Document* > documents;
+        for( const auto& uri : level )
+        {
+            const auto& imports = m_dependencies.imports( uri );
+            const auto affected =
+                std::any_of( imports.begin(), imports.end(), [&]( const std::string& import ) {
+                    return changed.count( import ) > 0;
+                } );
+            if( not affected )
+            {
+                continue;
+            }
+
+            const auto document = m_workspace.find( DocumentUri::fromString( uri ) );
+            if( document )
+            {
+                documents.emplace_back( document );
+            }
+        }
 
-    DiagnosticFormatter formatter( "casmd" );
-    Log::OutputStreamSink sink( std::cerr, formatter );
-    pm.stream().flush( sink );
+        const auto count = documents.size();
+        std::vector< std::unique_ptr< Analysis > > analyses( count );
+        std::vector< std::string > logs( count );
 
-    PublishDiagnosticsParams res( file.path(), formatter.diagnostics() );
+        for( std::size_t index = 0; index < count; index++ )
+        {
+            m_pool.submit( [&, index]() {
+                FlightRecorder::Span span( "analysis", documents[ index ]->uri().toString() );
+                std::ostringstream log;
+                std::unique_ptr< Analysis > analysis( new Analysis( documents[ index ]->file() ) );
+                analysis->run( log );
+                logs[ index ] = log.str();
+                analyses[ index ] = std::move( analysis );
+            } );
+        }
+
+        try
+        {
+            m_pool.wait();
+        }
+        catch( const std::exception& e )
+        {
+            m_log.error( "re-analysis of a dependent failed: " + std::string( e.what() ) );
+        }
+        catch( ... )
+        {
+            m_log.error( "re-analysis of a dependent failed" );
+        }
+
+        for( std::size_t index = 0; index < count; index++ )
+        {
+            // the document of a failed analysis keeps its previous one
+            if( not analyses[ index ] )
+            {
+                continue;
+            }
+
+            m_log.info( "re-analyzed dependent '" + documents[ index ]->uri().toString() + "'" );
+            std::cerr << logs[ index ];
+
+            if( textDocument_analyzed( *documents[ index ], *analyses[ index ] ) )
+            {
+                changed.emplace( documents[ index ]->uri().toString() );
+            }
+        }
 
-    textDocument_publishDiagnostics( res );
+        m_workspace.enforce();
+    }
 }
 
-std::string LanguageServer::textDocument_execute( const DocumentUri& fileuri, const u1 symbolic )
+std::string LanguageServer::textDocument_execute(
+    const DocumentUri& fileuri,
+    const u1 symbolic,
+    const std::string& arguments,
+    const Execution::Backend backend,
+    const u1 snapshots,
+    std::string& fallback )
 {
-    auto result = m_files.find( fileuri.toString() );
-    if( result == m_files.end() )
+    yield( Scheduler::Priority::BATCH );
+
+    auto document = m_workspace.find( fileuri );
+    if( not document )
     {
         const auto msg = "unable to find text document '" + fileuri.toString() + "'";
         m_log.error( msg );
         throw std::invalid_argument( msg );
     }
 
-    auto& file = result->second;
+    // interactive requests are served during the execution, it runs on a copy
+    // of the text in case the document is evicted in the meantime
+    const auto file = document->file();
+    const std::string command = symbolic ? "trace" : "run";
 
     m_log.info(
         std::to_string( (u64)&file ) + " ... " + fileuri.toString() + "\n\n" + file.data() );
 
-    PassResult pr;
-    pr.setOutput< LoadFilePass >( file );
+    // only deterministic models are memoized, the key and the determinism
+    // check cover the imported specifications as well.  Symbolic traces are
+    // cached per model and keyed by the tokens with their positions, an edit
+    // of comments or whitespace which moves no token reuses the whole trace
+    // including the positions it refers to.  The solver queries are issued
+    // inside the symbolic execution pass, any other edit traces the model
+    // again in full
+    const auto uri = fileuri.toString();
+    const auto scanned = Interface::scan( file.data(), uri );
+    const auto content = executionContent( file.data(), scanned );
+    auto& cache = symbolic ? m_traces : m_results;
+    std::string source = "";
+    std::string key = "";
+    ResultCache::Result result;
+
+    if( Interface::scan( content, uri ).deterministic() )
+    {
+        source = symbolic ? Interface::normalize( content ) : content;
+        key = ResultCache::key( source, command, arguments );
+
+        if( cache.find( key, source, result ) )
+        {
+            m_log.info( "served '" + command + "' of '" + uri + "' from the result cache" );
+            logMessage( "'" + command + "' result of '" + uri + "' served from cache" );
+
+            publishDiagnostics( fileuri, result.diagnostics );
+            document->setExecution( command, result.output );
+            m_workspace.enforce();
+            fallback = result.fallback;
+            return result.output;
+        }
+    }
+
+    Execution execution(
+        file, symbolic ? Execution::Kind::SYMBOLIC : Execution::Kind::NUMERIC );
+    execution.setBackend( backend );
+    execution.setYield( [this]( void ) { yield( Scheduler::Priority::ANALYSIS ); } );
+
+    if( not symbolic and snapshots )
+    {
+        // the snapshots of a previous run are replaced
+        m_snapshots.erase( uri );
+        const auto behavior = Interface::scan( content, uri ).behavior();
+        execution.setSnapshots( SNAPSHOT_INTERVAL, [&]( Snapshot&& snapshot ) {
+            keepSnapshot( uri, behavior, std::move( snapshot ) );
+        } );
+    }
+
+    {
+        FlightRecorder::Span span( command.c_str(), uri );
+        execution.run( std::cerr );
+    }
+    document = executed( fileuri );
+
+    if( not execution.error().empty() )
+    {
+        m_log.error( execution.error() );
+    }
+    fallback = execution.fallback();
+    if( not fallback.empty() )
+    {
+        m_log.info(
+            "'" + command + "' of '" + uri + "' fell back to the AST interpreter: " + fallback );
+    }
+
+    auto diagnostics = execution.diagnostics();
+    document->encode( diagnostics );
+    publishDiagnostics( fileuri, diagnostics );
+
+    const auto& output = execution.output();
+    document->setExecution( command, output );
+    m_workspace.enforce();
+
+    // aborted executions are not memoized, they may depend on the environment,
+    // and the diagnostics of a trace may point to positions of an old revision
+    if( not key.empty() and execution.error().empty() and
+        ( not symbolic or diagnostics.empty() ) )
+    {
+        result.source = source;
+        result.output = output;
+        result.fallback = fallback;
+        result.diagnostics.clear();
+        JsonWriter json( result.diagnostics );
+        casmd::Diagnostic::serialize( json, diagnostics );
+        cache.insert( key, result );
+    }
+
+    return output;
+}
+
+std::string LanguageServer::textDocument_profile( const DocumentUri& fileuri )
+{
+    yield( Scheduler::Priority::BATCH );
 
-    PassManager pm;
-    pm.setDefaultResult( pr );
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        const auto msg = "unable to find text document '" + fileuri.toString() + "'";
+        m_log.error( msg );
+        throw std::invalid_argument( msg );
+    }
 
-    if( not symbolic )
+    const auto file = document->file();
+    Execution execution( file, Execution::Kind::PROFILE );
+    execution.setYield( [this]( void ) { yield( Scheduler::Priority::ANALYSIS ); } );
     {
-        pm.setDefaultPass< libcasm_fe::NumericExecutionPass >();
+        FlightRecorder::Span span( "profile", fileuri.toString() );
+        execution.run( std::cerr );
+    }
+    document = executed( fileuri );
+
+    if( not execution.error().empty() )
+    {
+        m_log.error( execution.error() );
+    }
+
+    auto diagnostics = execution.diagnostics();
+    document->encode( diagnostics );
+    publishDiagnostics( fileuri, diagnostics );
+
+    auto profile = execution.profile();
+    profile.setRevision( document->revision() );
+    const auto report = profile.report();
+    document->setProfile( std::move( profile ) );
+    m_workspace.enforce();
+
+    // the client re-requests the code lenses of its visible documents
+    m_frames.emplace_back( Frame::message( Message::parse(
+        "{\"jsonrpc\":\"2.0\",\"id\":\"casmd-refresh-" + std::to_string( ++m_refreshId ) +
+        "\",\"method\":\"workspace/codeLens/refresh\"}" ) ) );
+
+    return execution.output() + "\n" + report;
+}
+
+std::string LanguageServer::textDocument_resume(
+    const DocumentUri& fileuri, const u64 step, std::string& fallback )
+{
+    yield( Scheduler::Priority::BATCH );
+
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        const auto msg = "unable to find text document '" + fileuri.toString() + "'";
+        m_log.error( msg );
+        throw std::invalid_argument( msg );
+    }
+
+    const auto uri = fileuri.toString();
+    Snapshot snapshot;
+    auto found = false;
+    const auto snapshots = m_snapshots.find( uri );
+    if( snapshots != m_snapshots.end() )
+    {
+        for( const auto& candidate : snapshots->second )
+        {
+            if( candidate.step() <= step )
+            {
+                snapshot = candidate;
+                found = true;
+            }
+        }
+    }
+
+    // the snapshot of an earlier server process
+    if( not found and not m_results.directory().empty() and
+        Snapshot::load( snapshotPath( uri ), snapshot ) and snapshot.step() <= step )
+    {
+        found = true;
+    }
+
+    if( not found )
+    {
+        throw std::invalid_argument( "no snapshot of '" + uri + "' to resume, run it first" );
+    }
+
+    const auto& text = document->file().data();
+    const auto scanned = Interface::scan( text, uri );
+    const auto behavior = Interface::scan( executionContent( text, scanned ), uri ).behavior();
+    if( behavior != snapshot.fingerprint() )
+    {
+        throw std::invalid_argument(
+            "the rules of '" + uri + "' changed since the snapshot at step " +
+            std::to_string( snapshot.step() ) + ", run it again" );
+    }
+
+    m_log.info( "resuming '" + uri + "' at step " + std::to_string( snapshot.step() ) );
+    const auto file = document->file();
+    Execution execution( file );
+    execution.resume( snapshot );
+    execution.setSnapshots( SNAPSHOT_INTERVAL, [&]( Snapshot&& taken ) {
+        keepSnapshot( uri, behavior, std::move( taken ) );
+    } );
+    execution.setYield( [this]( void ) { yield( Scheduler::Priority::ANALYSIS ); } );
+    {
+        FlightRecorder::Span span( "resume", uri );
+        execution.run( std::cerr );
+    }
+    document = executed( fileuri );
+
+    if( not execution.error().empty() )
+    {
+        m_log.error( execution.error() );
+    }
+
+    auto diagnostics = execution.diagnostics();
+    document->encode( diagnostics );
+    publishDiagnostics( fileuri, diagnostics );
+    logMessage(
+        "'" + uri + "' resumed at step " + std::to_string( snapshot.step() ) +
+        ", finished after " + std::to_string( execution.steps() ) + " steps" );
+
+    // the AST interpreter executes a fallback from the initial state
+    fallback = execution.fallback();
+    if( not fallback.empty() )
+    {
+        m_log.info( "resume of '" + uri + "' fell back to the AST interpreter: " + fallback );
+    }
+
+    const auto& output = execution.output();
+    document->setExecution( "run", output );
+    m_workspace.enforce();
+
+    return output;
+}
+
+Document* LanguageServer::executed( const DocumentUri& fileuri )
+{
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        const auto msg =
+            "text document '" + fileuri.toString() + "' was evicted during the execution";
+        m_log.error( msg );
+        throw std::invalid_argument( msg );
+    }
+    return document;
+}
+
+void LanguageServer::keepSnapshot(
+    const std::string& uri, const u64 behavior, Snapshot&& snapshot )
+{
+    snapshot.setFingerprint( behavior );
+    if( not m_results.directory().empty() and not snapshot.save( snapshotPath( uri ) ) )
+    {
+        m_log.error( "unable to persist the snapshot of '" + uri + "'" );
+    }
+
+    auto& snapshots = m_snapshots[ uri ];
+    snapshots.emplace_back( std::move( snapshot ) );
+    if( snapshots.size() > SNAPSHOTS )
+    {
+        snapshots.pop_front();
+    }
+}
+
+std::string LanguageServer::snapshotPath( const std::string& uri ) const
+{
+    return m_results.directory() + "/" + ResultCache::key( uri, "snapshot", "[]" ) + ".snapshot";
+}
+
+std::string LanguageServer::workspace_snapshots( void )
+{
+    std::string report = "";
+
+    for( const auto& entry : m_snapshots )
+    {
+        const auto document = m_workspace.find( DocumentUri::fromString( entry.first ) );
+        u64 behavior = 0;
+        if( document )
+        {
+            const auto& text = document->file().data();
+            const auto scanned = Interface::scan( text, entry.first );
+            const auto content = executionContent( text, scanned );
+            behavior = Interface::scan( content, entry.first ).behavior();
+        }
+
+        for( const auto& snapshot : entry.second )
+        {
+            report += entry.first + ": " + snapshot.describe() +
+                      ( snapshot.fingerprint() == behavior ? "" : ", rules changed" ) + "\n";
+        }
+    }
+
+    return report.empty() ? "no snapshots\n" : report;
+}
+
+std::string LanguageServer::executionContent( const std::string& text, const Interface& scanned )
+{
+    std::string content = text;
+
+    // the imports of imported specifications are loaded as well, every
+    // specification is appended once in the order of its first import
+    std::vector< std::string > imports( scanned.imports() );
+    std::unordered_set< std::string > visited( imports.begin(), imports.end() );
+
+    for( std::size_t index = 0; index < imports.size(); index++ )
+    {
+        const auto import = imports[ index ];
+        content += '\0' + import + '\0';
+
+        std::string imported = "";
+        const auto document = m_workspace.find( DocumentUri::fromString( import ) );
+        if( document )
+        {
+            imported = document->file().data();
+        }
+        else if( String::startsWith( import, "file://" ) )
+        {
+            try
+            {
+                imported = Batch::read( import.substr( 7 ) );
+            }
+            catch( const std::exception& e )
+            {
+                // not existing import candidate
+                continue;
+            }
+        }
+        content += imported;
+
+        for( const auto& nested : Interface::scan( imported, import ).imports() )
+        {
+            if( visited.insert( nested ).second )
+            {
+                imports.emplace_back( nested );
+            }
+        }
+    }
+
+    return content;
+}
+
+void LanguageServer::setCacheDirectory( const std::string& directory )
+{
+    m_results.setDirectory( directory );
+    m_traces.setDirectory( directory );
+}
+
+void LanguageServer::schedule(
+    Scheduler& scheduler, const std::function< void( const Scheduler::Request& ) >& handler )
+{
+    m_scheduler = &scheduler;
+    m_handler = handler;
+}
+
+void LanguageServer::yield( const Scheduler::Priority current )
+{
+    if( not m_scheduler )
+    {
+        return;
+    }
+
+    Scheduler::Request request;
+    while( m_scheduler->poll( current, request ) )
+    {
+        m_handler( request );
+    }
+}
+
+void LanguageServer::logMessage( const std::string& message )
+{
+    m_frames.emplace_back( Frame::notification( "window/logMessage", [&]( JsonWriter& json ) {
+        json.beginObject();
+        json.key( "type" ).number( 3 );  // Info
+        json.key( "message" ).string( message );
+        json.endObject();
+    } ) );
+}
+
+std::string LanguageServer::workspace_memory( void ) const
+{
+    std::string report = "";
+
+    for( const auto& document : m_workspace.documents() )
+    {
+        report += document.uri().toString() + ": " + ( document.isOpen() ? "open" : "closed" ) +
+                  ", revision " + std::to_string( document.revision() ) + ", text " +
+                  std::to_string( document.textUsage() ) + " bytes, artifacts " +
+                  std::to_string( document.artifactUsage() ) + " bytes\n";
+    }
+
+    report += "total: " + std::to_string( m_workspace.usage() ) + " of " +
+              std::to_string( m_workspace.budget() ) + " bytes, " +
+              std::to_string( m_workspace.documents().size() ) + " documents, " +
+              std::to_string( m_workspace.evictions() ) + " evictions\n";
+
+    report += "occurrences: " + std::to_string( m_occurrences.usage() ) + " bytes, " +
+              std::to_string( m_occurrences.size() ) + " symbols\n";
+
+    report += "results: " + std::to_string( m_results.usage() ) + " bytes, " +
+              std::to_string( m_results.hits() ) + " hits, " +
+              std::to_string( m_results.misses() ) + " misses" +
+              ( m_results.directory().empty() ? "" : ", persisted in " + m_results.directory() ) +
+              "\n";
+
+    report += "traces: " + std::to_string( m_traces.usage() ) + " bytes, " +
+              std::to_string( m_traces.hits() ) + " hits, " +
+              std::to_string( m_traces.misses() ) + " misses\n";
+
+    return report;
+}
+
+std::string LanguageServer::workspace_queue( void ) const
+{
+    if( not m_scheduler )
+    {
+        return "no dispatch queue attached\n";
+    }
+
+    std::string report = "";
+
+    for( std::size_t index = 0; index < Scheduler::PRIORITIES; index++ )
+    {
+        const auto priority = static_cast< Scheduler::Priority >( index );
+        const auto metrics = m_scheduler->metrics( priority );
+        const auto mean = metrics.requests > 0 ? metrics.totalWait / metrics.requests : 0;
+
+        report += std::string( Scheduler::name( priority ) ) + ": " +
+                  std::to_string( metrics.requests ) + " requests, " +
+                  std::to_string( metrics.queued ) + " queued, " +
+                  std::to_string( metrics.coalesced ) + " coalesced, wait mean " +
+                  std::to_string( mean ) + " us, p99 " + std::to_string( metrics.p99Wait ) +
+                  " us, max " + std::to_string( metrics.maximumWait ) + " us\n";
+    }
+
+    return report;
+}
+
+OccurrenceIndex::Occurrences LanguageServer::textDocument_references(
+    const DocumentUri& fileuri, const u32 line, const u32 character, std::string& name ) const
+{
+    const auto uri = fileuri.toString();
+    name = m_occurrences.symbol( uri, line, character );
+    if( name.empty() )
+    {
+        return OccurrenceIndex::Occurrences();
+    }
+
+    return m_occurrences.references( uri, name, m_dependencies );
+}
+
+std::string LanguageServer::textDocument_hoverContents(
+    const DocumentUri& fileuri, const u32 line, const u32 character )
+{
+    const auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        return "";
+    }
+
+    std::string contents = "";
+    for( const auto& diagnostic : document->diagnostics() )
+    {
+        const auto afterStart =
+            line > diagnostic.startLine or
+            ( line == diagnostic.startLine and character >= diagnostic.startCharacter );
+        const auto beforeEnd =
+            line < diagnostic.endLine or
+            ( line == diagnostic.endLine and character <= diagnostic.endCharacter );
+
+        if( afterStart and beforeEnd )
+        {
+            contents += ( contents.empty() ? "" : "\n" ) + diagnostic.message;
+        }
+    }
+
+    return contents;
+}
+
+Document* LanguageServer::textDocument_diagnostics( const DocumentUri& fileuri )
+{
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        throw std::invalid_argument( "unable to find text document '" + fileuri.toString() + "'" );
+    }
+
+    if( not document->analyzed() )
+    {
+        textDocument_analyze( fileuri );
+    }
+
+    return document;
+}
+
+void LanguageServer::workspace_diagnostic(
+    const std::string& id,
+    const std::unordered_map< std::string, std::string >& previousResultIds )
+{
+    // closed documents are not reported, the LRU order changes while the
+    // documents are looked up, therefore the URIs are collected first
+    std::vector< DocumentUri > fileuris;
+    for( const auto& document : m_workspace.documents() )
+    {
+        if( document.isOpen() )
+        {
+            fileuris.emplace_back( document.uri() );
+        }
+    }
+
+    m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+        json.beginObject();
+        json.key( "items" ).beginArray();
+        for( const auto& fileuri : fileuris )
+        {
+            const auto document = textDocument_diagnostics( fileuri );
+            const auto uri = fileuri.toString();
+            const auto previous = previousResultIds.find( uri );
+
+            diagnosticReport(
+                json,
+                *document,
+                previous != previousResultIds.end() ? previous->second : "",
+                uri );
+        }
+        json.endArray();
+        json.endObject();
+    } ) );
+}
+
+void LanguageServer::diagnosticReport(
+    JsonWriter& json,
+    const Document& document,
+    const std::string& previousResultId,
+    const std::string& uri ) const
+{
+    const auto& resultId = document.diagnosticsResultId();
+
+    json.beginObject();
+    if( not uri.empty() )
+    {
+        json.key( "uri" ).string( uri );
+        json.key( "version" ).number( document.revision() );
+    }
+
+    if( previousResultId == resultId )
+    {
+        json.key( "kind" ).string( "unchanged", 9 );
+        json.key( "resultId" ).string( resultId );
     }
     else
     {
-        pm.setDefaultPass< libcasm_fe::SymbolicExecutionPass >();
+        json.key( "kind" ).string( "full", 4 );
+        json.key( "resultId" ).string( resultId );
+        json.key( "items" ).raw( document.serializedDiagnostics() );
     }
+    json.endObject();
+}
 
-    std::ostringstream local;
-    auto cout_buff = std::cout.rdbuf();
-    std::cout.rdbuf( local.rdbuf() );
+const Outline& LanguageServer::textDocument_outline( const DocumentUri& fileuri )
+{
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        throw std::invalid_argument( "unable to find text document '" + fileuri.toString() + "'" );
+    }
 
-    try
+    if( not document->analyzed() )
     {
-        pm.run();
+        textDocument_analyze( fileuri );
     }
-    catch( const std::exception& e )
+
+    if( not document->outlined() )
     {
-        m_log.error( "pass manager triggered an exception: '" + std::string( e.what() ) + "'" );
+        document->setOutline( Outline::build(
+            document->analysis(), document->file().data(), document->lines() ) );
+        m_workspace.enforce();
     }
 
-    std::cout.rdbuf( cout_buff );
+    return document->outline();
+}
 
-    DiagnosticFormatter formatter( "casmd" );
-    Log::OutputStreamSink sink( std::cerr, formatter );
-    pm.stream().flush( sink );
+const std::string& LanguageServer::textDocument_lenses( const DocumentUri& fileuri )
+{
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        throw std::invalid_argument( "unable to find text document '" + fileuri.toString() + "'" );
+    }
 
-    PublishDiagnosticsParams res( file.path(), formatter.diagnostics() );
+    if( not document->analyzed() )
+    {
+        textDocument_analyze( fileuri );
+    }
 
-    textDocument_publishDiagnostics( res );
+    if( not document->lensed() )
+    {
+        document->setLenses( Profile::lenses(
+            document->analysis(),
+            document->file().data(),
+            document->lines(),
+            document->profile(),
+            document->revision(),
+            fileuri.toString() ) );
+        m_workspace.enforce();
+    }
 
-    return local.str();
+    return document->lenses();
+}
+
+void LanguageServer::textDocument_semanticTokens(
+    const std::string& id, const DocumentUri& fileuri, const std::string& previousResultId )
+{
+    auto document = m_workspace.find( fileuri );
+    if( not document )
+    {
+        throw std::invalid_argument( "unable to find text document '" + fileuri.toString() + "'" );
+    }
+
+    if( not document->analyzed() )
+    {
+        textDocument_analyze( fileuri );
+    }
+
+    // the tokens are collected once per revision and analysis, a repeated
+    // request answers with the stored ones and their result id
+    SemanticTokens::Edit edit;
+    const auto incremental =
+        not previousResultId.empty() and previousResultId == document->tokensResultId();
+    const auto collected = not document->tokenized();
+    auto changed = false;
+
+    if( collected )
+    {
+        const auto tokens = SemanticTokens::collect(
+            document->file().data(), document->lines(), document->analysis() );
+        auto data = SemanticTokens::encode( tokens );
+        changed = incremental and SemanticTokens::delta( document->tokens(), data, edit );
+        document->setTokens( std::to_string( ++m_tokensResultId ), std::move( data ) );
+    }
+
+    const auto& resultId = document->tokensResultId();
+    const auto& data = document->tokens();
+
+    m_frames.emplace_back( Frame::response( id, [&]( JsonWriter& json ) {
+        json.beginObject();
+        json.key( "resultId" ).string( resultId );
+        if( incremental )
+        {
+            json.key( "edits" ).beginArray();
+            if( changed )
+            {
+                json.beginObject();
+                json.key( "start" ).number( edit.start );
+                json.key( "deleteCount" ).number( edit.deleteCount );
+                json.key( "data" ).beginArray();
+                for( const auto value : edit.data )
+                {
+                    json.number( value );
+                }
+                json.endArray();
+                json.endObject();
+            }
+            json.endArray();
+        }
+        else
+        {
+            json.key( "data" ).beginArray();
+            for( const auto value : data )
+            {
+                json.number( value );
+            }
+            json.endArray();
+        }
+        json.endObject();
+    } ) );
+
+    if( collected )
+    {
+        m_workspace.enforce();
+    }
+}
+
+void LanguageServer::publishDiagnostics(
+    const DocumentUri& fileuri, const std::vector< casmd::Diagnostic >& diagnostics )
+{
+    const auto uri = fileuri.toString();
+    m_frames.emplace_back(
+        Frame::notification( "textDocument/publishDiagnostics", [&]( JsonWriter& json ) {
+            json.beginObject();
+            json.key( "uri" ).string( uri );
+            json.key( "diagnostics" );
+            casmd::Diagnostic::serialize( json, diagnostics );
+            json.endObject();
+        },
+        "textDocument/publishDiagnostics:" + uri ) );
+}
+
+void LanguageServer::publishDiagnostics(
+    const DocumentUri& fileuri, const std::string& serializedDiagnostics )
+{
+    const auto uri = fileuri.toString();
+    m_frames.emplace_back(
+        Frame::notification( "textDocument/publishDiagnostics", [&]( JsonWriter& json ) {
+            json.beginObject();
+            json.key( "uri" ).string( uri );
+            json.key( "diagnostics" ).raw( serializedDiagnostics );
+            json.endObject();
+        },
+        "textDocument/publishDiagnostics:" + uri ) );
 }
 
 //
@@ -30,11 +30,22 @@
    TODO
 */
 
+#include "Analysis.h"
+#include "DependencyGraph.h"
+#include "Execution.h"
+#include "Frame.h"
+#include "OccurrenceIndex.h"
+#include "ResultCache.h"
+#include "Scheduler.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "Workspace.h"
+
 #include <libstdhl/Log>
 #include <libstdhl/Type>
-#include <libstdhl/data/file/TextDocument>
 #include <libstdhl/net/lsp/LSP>
 
+#include <deque>
 #include <unordered_map>
 
 namespace casmd
@@ -44,7 +55,39 @@ namespace casmd
     class LanguageServer final : public libstdhl::Network::LSP::Server
     {
       public:
-        LanguageServer( libstdhl::Logger& log );
+        /**
+           'workers' is the amount of threads which analyze dependent
+           documents, zero selects the amount of hardware threads
+        */
+        LanguageServer(
+            libstdhl::Logger& log,
+            const std::size_t budget = Workspace::DEFAULT_BUDGET,
+            const std::size_t workers = 0 );
+
+        /**
+           processes hot requests directly with a streamed response frame,
+           returns 'false' if the request has to be processed by the default
+           LSP message processing
+        */
+        u1 dispatch( const libstdhl::Network::LSP::Message& request );
+
+        /**
+           passes all pending outbound frames to the callback
+        */
+        void drain( const std::function< void( const Frame& ) >& callback );
+
+        /**
+           persists the results of executions in 'directory'
+        */
+        void setCacheDirectory( const std::string& directory );
+
+        /**
+           attaches the dispatch queue, analyses and executions hand queued
+           requests of a higher class to 'handler' at their pass boundaries
+        */
+        void schedule(
+            Scheduler& scheduler,
+            const std::function< void( const Scheduler::Request& ) >& handler );
 
         libstdhl::Network::LSP::InitializeResult initialize(
             const libstdhl::Network::LSP::InitializeParams& params ) override;
@@ -81,6 +124,9 @@ namespace casmd
         void textDocument_didChange(
             const libstdhl::Network::LSP::DidChangeTextDocumentParams& params ) noexcept override;
 
+        void textDocument_didClose(
+            const libstdhl::Network::LSP::DidCloseTextDocumentParams& params ) noexcept override;
+
         //
         //
         // Language Features
@@ -96,14 +142,185 @@ namespace casmd
             const libstdhl::Network::LSP::CodeLensParams& params ) override;
 
       private:
-        void textDocument_analyze( const libstdhl::Network::LSP::DocumentUri& fileuri );
+        /**
+           analyzes the document, returns 'true' if its interface changed
+        */
+        u1 textDocument_analyze( const libstdhl::Network::LSP::DocumentUri& fileuri );
+
+        /**
+           stores the analysis of the document, publishes its diagnostics and
+           updates the dependency graph, returns 'true' if its interface
+           changed
+        */
+        u1 textDocument_analyzed( Document& document, const Analysis& analysis );
+
+        /**
+           re-analyzes the transitive dependents of the document level by
+           level, the documents of a level are analyzed on the pool while
+           their pass runs are serialized by the 'PassLock'.  A failed
+           analysis is logged and keeps the previous one of its document
+        */
+        void textDocument_analyzeDependents( const libstdhl::Network::LSP::DocumentUri& fileuri );
 
+        /**
+           executes the document, results of deterministic models are served
+           from the result cache if the content, the command and the
+           serialized 'arguments' are unchanged.  'backend' selects the
+           interpreter of a numeric execution, 'snapshots' keeps snapshots of
+           it on the flat backend.  'fallback' is set to the reason why the
+           flat backend fell back to the AST interpreter, or empty
+        */
         std::string textDocument_execute(
-            const libstdhl::Network::LSP::DocumentUri& fileuri, const u1 symbolic = false );
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const u1 symbolic,
+            const std::string& arguments,
+            const Execution::Backend backend,
+            const u1 snapshots,
+            std::string& fallback );
+
+        /**
+           executes the document with instrumented rule definitions, stores
+           the rule profile of the document and requests a refresh of the
+           code lenses
+        */
+        std::string textDocument_profile( const libstdhl::Network::LSP::DocumentUri& fileuri );
+
+        /**
+           continues the latest snapshot of the last 'run' of the document
+           taken at or before 'step', or the persisted one if the server has
+           none, the rules must be unchanged.  'fallback' is set like the one
+           of 'textDocument_execute', the output of a fallback is the one of
+           the whole execution
+        */
+        std::string textDocument_resume(
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const u64 step,
+            std::string& fallback );
+
+        std::string workspace_snapshots( void );
+
+        /**
+           keeps the latest snapshots of a document, the newest one is
+           persisted in the cache directory and survives a restart
+        */
+        void keepSnapshot( const std::string& uri, const u64 behavior, Snapshot&& snapshot );
+
+        /**
+           looks the document of an execution up again, the interactive
+           requests served by the execution may have evicted it
+        */
+        Document* executed( const libstdhl::Network::LSP::DocumentUri& fileuri );
+
+        std::string snapshotPath( const std::string& uri ) const;
+
+        /**
+           text of the document followed by the texts of its direct and
+           indirect imports
+        */
+        std::string executionContent( const std::string& text, const Interface& scanned );
+
+        /**
+           sends an informational 'window/logMessage' notification
+        */
+        void logMessage( const std::string& message );
+
+        std::string workspace_memory( void ) const;
+
+        /**
+           wait time metrics of the dispatch queue per class
+        */
+        std::string workspace_queue( void ) const;
+
+        /**
+           serves the queued requests of a class higher than 'current', the
+           served requests may run passes, therefore it is only called
+           between the passes of an execution
+        */
+        void yield( const Scheduler::Priority current );
+
+        /**
+           name of the indexed symbol at the position and its occurrences in
+           the documents sharing its declaration, the name is empty if the
+           position is not on a global symbol
+        */
+        OccurrenceIndex::Occurrences textDocument_references(
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const u32 line,
+            const u32 character,
+            std::string& name ) const;
+
+        std::string textDocument_hoverContents(
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const u32 line,
+            const u32 character );
+
+        /**
+           returns the document with up-to-date diagnostics, the analysis is
+           only run if its artifacts were evicted
+        */
+        Document* textDocument_diagnostics( const libstdhl::Network::LSP::DocumentUri& fileuri );
+
+        void workspace_diagnostic(
+            const std::string& id,
+            const std::unordered_map< std::string, std::string >& previousResultIds );
+
+        /**
+           serializes a full or an unchanged 'DocumentDiagnosticReport', a
+           non-empty 'uri' yields a 'WorkspaceDocumentDiagnosticReport'
+        */
+        void diagnosticReport(
+            JsonWriter& json,
+            const Document& document,
+            const std::string& previousResultId,
+            const std::string& uri = "" ) const;
+
+        /**
+           returns the cached outline of the document, it is derived once per
+           analysis revision
+        */
+        const Outline& textDocument_outline( const libstdhl::Network::LSP::DocumentUri& fileuri );
+
+        /**
+           returns the cached code lenses of the document, they are derived
+           once per analysis revision and profile
+        */
+        const std::string& textDocument_lenses(
+            const libstdhl::Network::LSP::DocumentUri& fileuri );
+
+        /**
+           responds with the full semantic tokens of the document, or with
+           the edits to the tokens of 'previousResultId' if they are still
+           the last ones sent to the client
+        */
+        void textDocument_semanticTokens(
+            const std::string& id,
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const std::string& previousResultId = "" );
+
+        void publishDiagnostics(
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const std::vector< Diagnostic >& diagnostics );
+
+        void publishDiagnostics(
+            const libstdhl::Network::LSP::DocumentUri& fileuri,
+            const std::string& serializedDiagnostics );
 
       private:
         libstdhl::Logger& m_log;
-        std::unordered_map< std::string, libstdhl::File::TextDocument > m_files;
+        Workspace m_workspace;
+        std::vector< Frame > m_frames;
+        u64 m_tokensResultId;
+        DependencyGraph m_dependencies;
+        OccurrenceIndex m_occurrences;
+        ThreadPool m_pool;
+        ResultCache m_results;
+
+        // whole symbolic traces per normalized model, not single solver queries
+        ResultCache m_traces;
+        u64 m_refreshId;
+        std::unordered_map< std::string, std::deque< Snapshot > > m_snapshots;
+        Scheduler* m_scheduler;
+        std::function< void( const Scheduler::Request& ) > m_handler;
     };
 }
 
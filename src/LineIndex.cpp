@@ -0,0 +1,225 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "LineIndex.h"
+
+#include <algorithm>
+
+#if defined( __SSE2__ ) && defined( __GNUC__ )
+#include <emmintrin.h>
+#endif
+
+using namespace casmd;
+
+/**
+   UTF-16 code units of the UTF-8 sequence starting with 'lead', the
+   continuation bytes are not counted
+*/
+static u32 units( const unsigned char lead )
+{
+    if( ( lead & 0xc0 ) == 0x80 )
+    {
+        return 0;
+    }
+    return lead >= 0xf0 ? 2 : 1;
+}
+
+static std::size_t sequence( const unsigned char lead )
+{
+    if( lead >= 0xf0 )
+    {
+        return 4;
+    }
+    if( lead >= 0xe0 )
+    {
+        return 3;
+    }
+    if( lead >= 0xc0 )
+    {
+        return 2;
+    }
+    return 1;
+}
+
+LineIndex::LineIndex( void )
+: m_starts( { 0 } )
+, m_ascii( { true } )
+, m_size( 0 )
+{
+}
+
+LineIndex::LineIndex( const std::string& text )
+: m_starts()
+, m_ascii()
+, m_size( text.size() )
+{
+    scan( text );
+}
+
+std::size_t LineIndex::lines( void ) const
+{
+    return m_starts.size();
+}
+
+std::size_t LineIndex::start( const u32 line ) const
+{
+    return line < m_starts.size() ? m_starts[ line ] : m_size;
+}
+
+std::size_t LineIndex::end( const u32 line ) const
+{
+    return static_cast< std::size_t >( line ) + 1 < m_starts.size() ? m_starts[ line + 1 ] - 1
+                                                                    : m_size;
+}
+
+LineIndex::Position LineIndex::position( const std::string& text, const std::size_t offset ) const
+{
+    const auto clamped = std::min( offset, m_size );
+    const auto next = std::upper_bound( m_starts.begin(), m_starts.end(), clamped );
+    const auto line = static_cast< u32 >( next - m_starts.begin() - 1 );
+    return { line, character( text, line, static_cast< u32 >( clamped - m_starts[ line ] ) ) };
+}
+
+std::size_t LineIndex::offset( const std::string& text, const Position& position ) const
+{
+    if( position.line >= m_starts.size() )
+    {
+        return m_size;
+    }
+
+    const auto begin = m_starts[ position.line ];
+    const auto stop = end( position.line );
+    if( m_ascii[ position.line ] )
+    {
+        return begin + std::min< std::size_t >( position.character, stop - begin );
+    }
+
+    u32 count = 0;
+    auto current = begin;
+    while( current < stop )
+    {
+        const auto lead = static_cast< unsigned char >( text[ current ] );
+        const auto width = units( lead );
+        if( count + width > position.character )
+        {
+            break;
+        }
+        count += width;
+        current += sequence( lead );
+    }
+    return std::min( current, stop );
+}
+
+u32 LineIndex::character( const std::string& text, const u32 line, const u32 column ) const
+{
+    if( line >= m_starts.size() or m_ascii[ line ] )
+    {
+        return column;
+    }
+
+    const auto begin = m_starts[ line ];
+    const auto stop = std::min( begin + column, m_size );
+    u32 count = 0;
+    for( auto current = begin; current < stop; current++ )
+    {
+        count += units( static_cast< unsigned char >( text[ current ] ) );
+    }
+    return count;
+}
+
+std::size_t LineIndex::usage( void ) const
+{
+    return m_starts.capacity() * sizeof( std::size_t ) + m_ascii.capacity() / 8;
+}
+
+void LineIndex::scan( const std::string& text )
+{
+    // one line per ~40 bytes is a common density of specifications
+    m_starts.reserve( text.size() / 40 + 1 );
+    m_ascii.reserve( text.size() / 40 + 1 );
+    m_starts.push_back( 0 );
+
+    const auto data = text.data();
+    const auto size = text.size();
+    std::size_t position = 0;
+    u1 ascii = true;
+
+#if defined( __SSE2__ ) && defined( __GNUC__ )
+    // sixteen bytes at once, the blocks without newlines and non-ASCII bytes
+    // are skipped by a single test
+    const auto newline = _mm_set1_epi8( '\n' );
+    for( ; position + 16 <= size; position += 16 )
+    {
+        const auto block =
+            _mm_loadu_si128( reinterpret_cast< const __m128i* >( data + position ) );
+        const auto newlines =
+            static_cast< u32 >( _mm_movemask_epi8( _mm_cmpeq_epi8( block, newline ) ) );
+        auto marks = newlines | static_cast< u32 >( _mm_movemask_epi8( block ) );
+
+        while( marks != 0 )
+        {
+            const auto bit = static_cast< u32 >( __builtin_ctz( marks ) );
+            marks &= marks - 1;
+
+            if( newlines & ( 1u << bit ) )
+            {
+                m_ascii.push_back( ascii );
+                m_starts.push_back( position + bit + 1 );
+                ascii = true;
+            }
+            else
+            {
+                ascii = false;
+            }
+        }
+    }
+#endif
+
+    for( ; position < size; position++ )
+    {
+        const auto c = static_cast< unsigned char >( data[ position ] );
+        if( c == '\n' )
+        {
+            m_ascii.push_back( ascii );
+            m_starts.push_back( position + 1 );
+            ascii = true;
+        }
+        else if( c >= 0x80 )
+        {
+            ascii = false;
+        }
+    }
+
+    m_ascii.push_back( ascii );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
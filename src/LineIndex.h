@@ -0,0 +1,114 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_LINE_INDEX_H_
+#define _CASMD_LINE_INDEX_H_
+
+/**
+   @brief    line starts of a text revision
+
+   The index keeps the byte offset of every line start, found by a vectorized
+   scan for newlines, and a flag per line whether it is pure ASCII.  Offsets
+   are converted to LSP positions (zero-based line and UTF-16 code unit) and
+   back by a binary search over the line starts, only lines with non-ASCII
+   characters are decoded.  The index does not keep the text, it is passed
+   again to the conversions and has to be the indexed revision.
+*/
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u32 = libstdhl::u32;
+
+    class LineIndex
+    {
+      public:
+        struct Position
+        {
+            u32 line;
+            u32 character;
+        };
+
+        LineIndex( void );
+
+        explicit LineIndex( const std::string& text );
+
+        std::size_t lines( void ) const;
+
+        /**
+           byte offset of the start of 'line', the size of the text for lines
+           after the last one
+        */
+        std::size_t start( const u32 line ) const;
+
+        /**
+           byte offset of the end of 'line' excl. its newline
+        */
+        std::size_t end( const u32 line ) const;
+
+        /**
+           position of the byte 'offset', O(log n) in the amount of lines
+        */
+        Position position( const std::string& text, const std::size_t offset ) const;
+
+        /**
+           byte offset of 'position', characters beyond the end of the line
+           are clamped to it like the LSP requires
+        */
+        std::size_t offset( const std::string& text, const Position& position ) const;
+
+        /**
+           UTF-16 character of the byte 'column' of 'line', O(1) for ASCII
+           lines
+        */
+        u32 character( const std::string& text, const u32 line, const u32 column ) const;
+
+        std::size_t usage( void ) const;
+
+      private:
+        void scan( const std::string& text );
+
+      private:
+        std::vector< std::size_t > m_starts;
+        std::vector< u1 > m_ascii;
+        std::size_t m_size;
+    };
+}
+
+#endif  // _CASMD_LINE_INDEX_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
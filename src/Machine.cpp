@@ -0,0 +1,1701 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "Machine.h"
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libcasm-fe/ast/RecursiveVisitor>
+#include <libcasm-ir/Constant>
+#include <libcasm-ir/Type>
+#include <libcasm-ir/Value>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+using namespace casmd;
+using namespace libcasm_fe;
+
+// location of the program function of the single agent
+static constexpr u32 PROGRAM_FUNCTION = std::numeric_limits< u32 >::max();
+
+// entry of a routine which is referenced but not lowered yet
+static constexpr u32 UNRESOLVED = std::numeric_limits< u32 >::max();
+
+// functions with more arguments are not lowered
+static constexpr std::size_t MAXIMUM_ARITY = 2;
+
+static constexpr i64 MINIMUM = std::numeric_limits< i64 >::min();
+static constexpr i64 MAXIMUM = std::numeric_limits< i64 >::max();
+
+namespace
+{
+    /**
+       leaves the subset of the machine, the specification is executed by the
+       AST interpreter instead
+    */
+    struct Unsupported
+    {
+        std::string reason;
+    };
+}
+
+[[noreturn]] static void unsupported( const std::string& reason )
+{
+    throw Unsupported{ reason };
+}
+
+static std::string at( const Ast::Node& node )
+{
+    return " at line " + std::to_string( node.sourceLocation().begin.line );
+}
+
+static u1 scalar( const libcasm_ir::Type::Ptr& type )
+{
+    return type and ( type->isInteger() or type->isBoolean() );
+}
+
+//
+//
+// Integer Arithmetic
+//
+// The AST interpreter computes with arbitrary precision, an overflow of the
+// 64-bit machine integers therefore aborts the execution.
+//
+
+static i64 add( const i64 lhs, const i64 rhs )
+{
+    if( ( rhs > 0 and lhs > MAXIMUM - rhs ) or ( rhs < 0 and lhs < MINIMUM - rhs ) )
+    {
+        unsupported( "integer overflow" );
+    }
+    return lhs + rhs;
+}
+
+static i64 subtract( const i64 lhs, const i64 rhs )
+{
+    if( ( rhs < 0 and lhs > MAXIMUM + rhs ) or ( rhs > 0 and lhs < MINIMUM + rhs ) )
+    {
+        unsupported( "integer overflow" );
+    }
+    return lhs - rhs;
+}
+
+static i64 multiply( const i64 lhs, const i64 rhs )
+{
+    const auto overflow = lhs > 0 ? ( rhs > 0 ? lhs > MAXIMUM / rhs : rhs < MINIMUM / lhs )
+                                  : ( rhs > 0 ? lhs < MINIMUM / rhs
+                                              : ( lhs != 0 and rhs < MAXIMUM / lhs ) );
+    if( overflow )
+    {
+        unsupported( "integer overflow" );
+    }
+    return lhs * rhs;
+}
+
+static i64 power( i64 base, i64 exponent )
+{
+    if( exponent < 0 )
+    {
+        unsupported( "negative exponent" );
+    }
+
+    i64 result = 1;
+    while( exponent > 0 )
+    {
+        if( exponent & 1 )
+        {
+            result = multiply( result, base );
+        }
+        exponent >>= 1;
+        if( exponent > 0 )
+        {
+            base = multiply( base, base );
+        }
+    }
+    return result;
+}
+
+static void divisible( const i64 lhs, const i64 rhs )
+{
+    // the rounding of negative operands is left to the AST interpreter
+    if( rhs <= 0 or lhs < 0 )
+    {
+        unsupported( "division of non-positive integers" );
+    }
+}
+
+//
+//
+// Machine::Compiler
+//
+
+/**
+   lowers the definitions of a specification, every supported node claims
+   itself and lowers its children explicitly.  A node without an override
+   is traversed by the recursive default and therefore never claimed, or it
+   reaches a supported child which is not the expected node, both abort the
+   compilation.
+*/
+class Machine::Compiler final : public Ast::RecursiveVisitor
+{
+  public:
+    Compiler( Machine& machine )
+    : m_machine( machine )
+    , m_expected( nullptr )
+    , m_result( 0 )
+    , m_routines()
+    , m_functions()
+    , m_rules()
+    , m_locals()
+    , m_count( 0 )
+    , m_references()
+    , m_init()
+    {
+    }
+
+    void compile( Ast::Specification& specification )
+    {
+        for( const auto& definition : *specification.definitions() )
+        {
+            lower( *definition );
+        }
+
+        // rule references are resolved by name once all rules are lowered
+        for( const auto& reference : m_references )
+        {
+            m_machine.m_program[ reference.first ].value = rule( reference.second );
+        }
+
+        if( m_init.empty() )
+        {
+            unsupported( "no initial rule" );
+        }
+        m_machine.m_main = rule( m_init );
+        if( m_machine.m_routines[ m_machine.m_main ].parameters != 0 )
+        {
+            unsupported( "initial rule with parameters" );
+        }
+
+        for( const auto& routine : m_machine.m_routines )
+        {
+            if( routine.entry == UNRESOLVED )
+            {
+                unsupported( "call of a definition outside of the specification" );
+            }
+        }
+    }
+
+    //
+    // Definitions
+    //
+
+    void visit( Ast::InitDefinition& node ) override
+    {
+        claim( node );
+        if( not node.initPath() )
+        {
+            unsupported( "initialization of several agents" + at( node ) );
+        }
+        m_init = node.initPath()->baseName();
+    }
+
+    void visit( Ast::FunctionDefinition& node ) override
+    {
+        claim( node );
+        if( node.identifier()->name() == "program" )
+        {
+            // the program function of the agents is lowered to 'PROGRAM'
+            return;
+        }
+
+        const auto arity = node.argumentTypes()->size();
+        const auto slot = function( &node, arity );
+
+        if( node.defined() )
+        {
+            const auto index = value( *node.defined()->expression() );
+            const auto& instruction = m_machine.m_program[ index ];
+            if( instruction.op != Op::CONSTANT )
+            {
+                unsupported( "computed default value" + at( node ) );
+            }
+            const Value fallback = { instruction.value,
+                                     static_cast< Value::Kind >( instruction.kind ) };
+            m_machine.m_functions[ slot ].value = fallback;
+            m_machine.m_functions[ slot ].fallback = fallback;
+        }
+
+        if( node.initially() )
+        {
+            for( const auto& initializer : *node.initially()->initializers() )
+            {
+                std::vector< u32 > arguments;
+                if( initializer->arguments() )
+                {
+                    arguments = values( *initializer->arguments() );
+                }
+                if( arguments.size() != arity )
+                {
+                    unsupported( "initializer of a different arity" + at( *initializer ) );
+                }
+
+                const auto initial = value( *initializer->value() );
+                m_machine.m_initializers.push_back( emit(
+                    Op::UPDATE, operands( arguments ), arguments.size(), initial, slot ) );
+            }
+        }
+    }
+
+    void visit( Ast::DerivedDefinition& node ) override
+    {
+        claim( node );
+        const auto index = routine( &node );
+        const auto parameters = begin( *node.arguments() );
+        const auto entry = value( *node.expression() );
+        m_machine.m_routines[ index ] = { entry, parameters, m_count };
+    }
+
+    void visit( Ast::RuleDefinition& node ) override
+    {
+        claim( node );
+        const auto index = routine( &node );
+        m_rules.emplace( node.identifier()->name(), index );
+        const auto parameters = begin( *node.arguments() );
+        const auto entry = lower( *node.rule() );
+        m_machine.m_routines[ index ] = { entry, parameters, m_count };
+    }
+
+    //
+    // Rules
+    //
+
+    void visit( Ast::SkipRule& node ) override
+    {
+        claim( node );
+        m_result = emit( Op::SKIP );
+    }
+
+    void visit( Ast::BlockRule& node ) override
+    {
+        claim( node );
+        m_result = list( Op::BLOCK, *node.rules() );
+    }
+
+    void visit( Ast::SequenceRule& node ) override
+    {
+        claim( node );
+        m_result = list( Op::SEQUENCE, *node.rules() );
+    }
+
+    void visit( Ast::ConditionalRule& node ) override
+    {
+        claim( node );
+        const auto condition = boolean( *node.condition() );
+        const auto thenRule = lower( *node.thenRule() );
+        const auto elseRule = node.elseRule() ? lower( *node.elseRule() ) : emit( Op::SKIP );
+        m_result = emit( Op::CONDITIONAL, condition, thenRule, elseRule );
+    }
+
+    void visit( Ast::LetRule& node ) override
+    {
+        claim( node );
+        std::vector< std::pair< u32, u32 > > bindings;
+        for( const auto& binding : *node.variableBindings() )
+        {
+            const auto expression = value( *binding->expression() );
+            bindings.emplace_back( declare( *binding->variable() ), expression );
+        }
+
+        auto body = lower( *node.rule() );
+        for( auto binding = bindings.rbegin(); binding != bindings.rend(); ++binding )
+        {
+            body = emit( Op::LET, binding->second, body, 0, binding->first );
+        }
+        m_result = body;
+    }
+
+    void visit( Ast::ForallRule& node ) override
+    {
+        claim( node );
+        if( node.variables()->size() != 1 )
+        {
+            unsupported( "forall over several variables" + at( node ) );
+        }
+
+        const auto universe = lower( *node.universe() );
+        if( m_machine.m_program[ universe ].op != Op::RANGE )
+        {
+            unsupported( "forall over a universe other than an integer range" + at( node ) );
+        }
+
+        const auto slot = declare( **node.variables()->begin() );
+        auto body = lower( *node.rule() );
+        if( node.condition() )
+        {
+            const auto condition = boolean( *node.condition() );
+            const auto& instruction = m_machine.m_program[ condition ];
+            if( not( instruction.op == Op::CONSTANT and instruction.value == 1 ) )
+            {
+                body = emit( Op::CONDITIONAL, condition, body, emit( Op::SKIP ) );
+            }
+        }
+        m_result = emit( Op::FORALL, universe, body, 0, slot );
+    }
+
+    void visit( Ast::UpdateRule& node ) override
+    {
+        claim( node );
+        const auto& target = *node.function();
+        if( target.targetType() != Ast::DirectCallExpression::TargetType::FUNCTION )
+        {
+            unsupported( "update of a non-function" + at( node ) );
+        }
+
+        if( target.identifier()->baseName() == "program" )
+        {
+            // the arguments select the agent, there is only 'self'
+            const auto rule = lower( *node.expression() );
+            const auto& instruction = m_machine.m_program[ rule ];
+            if( instruction.op != Op::CONSTANT or
+                ( instruction.kind != Value::UNDEF and instruction.kind != Value::RULE ) )
+            {
+                unsupported( "computed program rule" + at( node ) );
+            }
+            m_result = emit( Op::PROGRAM, rule );
+            return;
+        }
+
+        const auto arguments = values( *target.arguments() );
+        const auto slot = function( target.targetDefinition().get(), arguments.size() );
+        const auto update = value( *node.expression() );
+        m_result = emit( Op::UPDATE, operands( arguments ), arguments.size(), update, slot );
+    }
+
+    void visit( Ast::CallRule& node ) override
+    {
+        claim( node );
+        const auto call = lower( *node.call() );
+        const auto op = m_machine.m_program[ call ].op;
+        if( op != Op::CALL and op != Op::PRINT )
+        {
+            unsupported( "call of a value" + at( node ) );
+        }
+        m_result = call;
+    }
+
+    //
+    // Expressions
+    //
+
+    void visit( Ast::ValueAtom& node ) override
+    {
+        claim( node );
+        const auto& constant = *node.value();
+        const auto& type = constant.type();
+
+        if( not constant.defined() )
+        {
+            m_result = emit( Op::CONSTANT, 0, 0, 0, 0, Value::UNDEF );
+        }
+        else if( type.isBoolean() )
+        {
+            m_result = emit( Op::CONSTANT, 0, 0, 0, constant.name() == "true", Value::BOOLEAN );
+        }
+        else if( type.isInteger() )
+        {
+            const auto name = constant.name();
+            char* end = nullptr;
+            errno = 0;
+            const auto number = std::strtoll( name.c_str(), &end, 10 );
+            if( errno != 0 or *end != '\0' )
+            {
+                unsupported( "integer constant beyond 64 bits" + at( node ) );
+            }
+            m_result = emit( Op::CONSTANT, 0, 0, 0, number, Value::INTEGER );
+        }
+        else if( type.isString() )
+        {
+            m_machine.m_strings.emplace_back( constant.name() );
+            m_result = emit( Op::TEXT, 0, 0, 0, m_machine.m_strings.size() - 1 );
+        }
+        else if( type.isRuleReference() )
+        {
+            auto name = constant.name();
+            if( not name.empty() and name.front() == '@' )
+            {
+                name.erase( 0, 1 );
+            }
+            m_result = reference( name );
+        }
+        else
+        {
+            unsupported( "constant of an unsupported type" + at( node ) );
+        }
+    }
+
+    void visit( Ast::UndefAtom& node ) override
+    {
+        claim( node );
+        m_result = emit( Op::CONSTANT, 0, 0, 0, 0, Value::UNDEF );
+    }
+
+    void visit( Ast::ReferenceAtom& node ) override
+    {
+        claim( node );
+        if( node.referenceType() != Ast::ReferenceAtom::ReferenceType::RULE )
+        {
+            unsupported( "reference to a non-rule" + at( node ) );
+        }
+        m_result = reference( node.identifier()->baseName() );
+    }
+
+    void visit( Ast::DirectCallExpression& node ) override
+    {
+        claim( node );
+        const auto& name = node.identifier()->baseName();
+
+        switch( node.targetType() )
+        {
+            case Ast::DirectCallExpression::TargetType::VARIABLE:
+            {
+                const auto local = m_locals.find( node.targetDefinition().get() );
+                if( local == m_locals.end() )
+                {
+                    unsupported( "variable '" + name + "' outside of its frame" + at( node ) );
+                }
+                m_result = emit( Op::LOCAL, 0, 0, 0, local->second );
+                break;
+            }
+            case Ast::DirectCallExpression::TargetType::FUNCTION:
+            {
+                if( name == "program" )
+                {
+                    unsupported( "lookup of the program function" + at( node ) );
+                }
+                const auto arguments = values( *node.arguments() );
+                const auto slot = function( node.targetDefinition().get(), arguments.size() );
+                m_result = emit( Op::LOOKUP, operands( arguments ), arguments.size(), 0, slot );
+                break;
+            }
+            case Ast::DirectCallExpression::TargetType::DERIVED: // [[fallthrough]]
+            case Ast::DirectCallExpression::TargetType::RULE:
+            {
+                const auto derived =
+                    node.targetType() == Ast::DirectCallExpression::TargetType::DERIVED;
+                const auto arguments = values( *node.arguments() );
+                m_result = emit(
+                    derived ? Op::DERIVED : Op::CALL,
+                    operands( arguments ),
+                    arguments.size(),
+                    0,
+                    routine( node.targetDefinition().get() ) );
+                break;
+            }
+            case Ast::DirectCallExpression::TargetType::BUILTIN:
+            {
+                if( ( name != "print" and name != "println" ) or node.arguments()->size() != 1 )
+                {
+                    unsupported( "builtin '" + name + "'" + at( node ) );
+                }
+                const auto message = text( **node.arguments()->begin() );
+                m_result = emit( Op::PRINT, message, 0, 0, name == "println" );
+                break;
+            }
+            default:
+            {
+                unsupported( "call of '" + name + "'" + at( node ) );
+            }
+        }
+    }
+
+    void visit( Ast::UnaryExpression& node ) override
+    {
+        claim( node );
+        switch( node.op() )
+        {
+            case libcasm_ir::Value::NOT_INSTRUCTION:
+            {
+                m_result = emit( Op::NOT, boolean( *node.expression() ) );
+                break;
+            }
+            case libcasm_ir::Value::INV_INSTRUCTION:
+            {
+                m_result = emit( Op::INV, integer( *node.expression() ) );
+                break;
+            }
+            default:
+            {
+                unsupported( "unary operator" + at( node ) );
+            }
+        }
+    }
+
+    void visit( Ast::BinaryExpression& node ) override
+    {
+        claim( node );
+        if( node.type() and node.type()->isString() )
+        {
+            if( node.op() != libcasm_ir::Value::ADD_INSTRUCTION )
+            {
+                unsupported( "string operator" + at( node ) );
+            }
+            const auto left = text( *node.left() );
+            m_result = emit( Op::CONCAT, left, text( *node.right() ) );
+            return;
+        }
+
+        const auto op = binary( node );
+        const auto left = value( *node.left() );
+        m_result = emit( op, left, value( *node.right() ) );
+    }
+
+    void visit( Ast::ConditionalExpression& node ) override
+    {
+        claim( node );
+        const auto condition = boolean( *node.condition() );
+        const auto thenExpression = value( *node.thenExpression() );
+        const auto elseExpression = value( *node.elseExpression() );
+        m_result = emit( Op::SELECT, condition, thenExpression, elseExpression );
+    }
+
+    void visit( Ast::TypeCastingExpression& node ) override
+    {
+        claim( node );
+        if( not node.type() or not node.type()->isString() )
+        {
+            unsupported( "type cast to a non-string" + at( node ) );
+        }
+        m_result = emit( Op::FORMAT, value( *node.fromExpression() ) );
+    }
+
+    void visit( Ast::RangeLiteral& node ) override
+    {
+        claim( node );
+        const auto left = integer( *node.left() );
+        m_result = emit( Op::RANGE, left, integer( *node.right() ) );
+    }
+
+  private:
+    u32 lower( Ast::Node& node )
+    {
+        const auto previous = m_expected;
+        m_expected = &node;
+        node.accept( *this );
+        if( m_expected == &node )
+        {
+            unsupported( "unsupported construct" + at( node ) );
+        }
+        m_expected = previous;
+        return m_result;
+    }
+
+    void claim( Ast::Node& node )
+    {
+        if( m_expected != &node )
+        {
+            // reached by the recursive default of an unsupported parent
+            unsupported( "unsupported construct" + at( m_expected ? *m_expected : node ) );
+        }
+        m_expected = nullptr;
+    }
+
+    u32 value( Ast::Expression& expression )
+    {
+        const auto index = lower( expression );
+        if( not scalar( expression.type() ) )
+        {
+            unsupported( "value of an unsupported type" + at( expression ) );
+        }
+        return index;
+    }
+
+    u32 integer( Ast::Expression& expression )
+    {
+        const auto index = lower( expression );
+        if( not expression.type() or not expression.type()->isInteger() )
+        {
+            unsupported( "integer operand of an unsupported type" + at( expression ) );
+        }
+        return index;
+    }
+
+    u32 boolean( Ast::Expression& expression )
+    {
+        const auto index = lower( expression );
+        if( not expression.type() or not expression.type()->isBoolean() )
+        {
+            unsupported( "condition of an unsupported type" + at( expression ) );
+        }
+        return index;
+    }
+
+    u32 text( Ast::Expression& expression )
+    {
+        const auto index = lower( expression );
+        const auto op = m_machine.m_program[ index ].op;
+        if( op != Op::TEXT and op != Op::CONCAT and op != Op::FORMAT )
+        {
+            unsupported( "printed value of an unsupported type" + at( expression ) );
+        }
+        return index;
+    }
+
+    template < typename Expressions >
+    std::vector< u32 > values( Expressions& expressions )
+    {
+        std::vector< u32 > indices;
+        for( const auto& expression : expressions )
+        {
+            indices.push_back( value( *expression ) );
+        }
+        return indices;
+    }
+
+    template < typename Rules >
+    u32 list( const Op op, Rules& rules )
+    {
+        std::vector< u32 > indices;
+        for( const auto& rule : rules )
+        {
+            indices.push_back( lower( *rule ) );
+        }
+        return emit( op, operands( indices ), indices.size() );
+    }
+
+    Op binary( Ast::BinaryExpression& node ) const
+    {
+        switch( node.op() )
+        {
+            case libcasm_ir::Value::ADD_INSTRUCTION:
+            {
+                return Op::ADD;
+            }
+            case libcasm_ir::Value::SUB_INSTRUCTION:
+            {
+                return Op::SUB;
+            }
+            case libcasm_ir::Value::MUL_INSTRUCTION:
+            {
+                return Op::MUL;
+            }
+            case libcasm_ir::Value::DIV_INSTRUCTION:
+            {
+                return Op::DIV;
+            }
+            case libcasm_ir::Value::MOD_INSTRUCTION:
+            {
+                return Op::MOD;
+            }
+            case libcasm_ir::Value::POW_INSTRUCTION:
+            {
+                return Op::POW;
+            }
+            case libcasm_ir::Value::EQU_INSTRUCTION:
+            {
+                return Op::EQU;
+            }
+            case libcasm_ir::Value::NEQ_INSTRUCTION:
+            {
+                return Op::NEQ;
+            }
+            case libcasm_ir::Value::LTH_INSTRUCTION:
+            {
+                return Op::LTH;
+            }
+            case libcasm_ir::Value::LEQ_INSTRUCTION:
+            {
+                return Op::LEQ;
+            }
+            case libcasm_ir::Value::GTH_INSTRUCTION:
+            {
+                return Op::GTH;
+            }
+            case libcasm_ir::Value::GEQ_INSTRUCTION:
+            {
+                return Op::GEQ;
+            }
+            case libcasm_ir::Value::AND_INSTRUCTION:
+            {
+                return Op::AND;
+            }
+            case libcasm_ir::Value::OR_INSTRUCTION:
+            {
+                return Op::OR;
+            }
+            case libcasm_ir::Value::XOR_INSTRUCTION:
+            {
+                return Op::XOR;
+            }
+            case libcasm_ir::Value::IMP_INSTRUCTION:
+            {
+                return Op::IMP;
+            }
+            default:
+            {
+                unsupported( "binary operator" + at( node ) );
+            }
+        }
+    }
+
+    u32 emit(
+        const Op op,
+        const std::size_t first = 0,
+        const std::size_t second = 0,
+        const std::size_t third = 0,
+        const i64 value = 0,
+        const Value::Kind kind = Value::UNDEF )
+    {
+        m_machine.m_program.push_back( { op,
+                                         kind,
+                                         static_cast< u32 >( first ),
+                                         static_cast< u32 >( second ),
+                                         static_cast< u32 >( third ),
+                                         value } );
+        return static_cast< u32 >( m_machine.m_program.size() - 1 );
+    }
+
+    u32 operands( const std::vector< u32 >& indices )
+    {
+        const auto offset = m_machine.m_operands.size();
+        m_machine.m_operands.insert( m_machine.m_operands.end(), indices.begin(), indices.end() );
+        return static_cast< u32 >( offset );
+    }
+
+    u32 reference( const std::string& name )
+    {
+        const auto index = emit( Op::CONSTANT, 0, 0, 0, 0, Value::RULE );
+        m_references.emplace_back( index, name );
+        return index;
+    }
+
+    u32 rule( const std::string& name ) const
+    {
+        const auto rule = m_rules.find( name );
+        if( rule == m_rules.end() )
+        {
+            unsupported( "unknown rule '" + name + "'" );
+        }
+        return rule->second;
+    }
+
+    u32 routine( const Ast::Node* definition )
+    {
+        const auto routine = m_routines.find( definition );
+        if( routine != m_routines.end() )
+        {
+            return routine->second;
+        }
+
+        m_machine.m_routines.push_back( { UNRESOLVED, 0, 0 } );
+        const auto index = static_cast< u32 >( m_machine.m_routines.size() - 1 );
+        m_routines.emplace( definition, index );
+        return index;
+    }
+
+    u32 function( const Ast::Node* definition, const std::size_t arity )
+    {
+        if( arity > MAXIMUM_ARITY )
+        {
+            unsupported( "function with more than " + std::to_string( MAXIMUM_ARITY ) +
+                         " arguments" );
+        }
+
+        const auto function = m_functions.find( definition );
+        if( function != m_functions.end() )
+        {
+            return function->second;
+        }
+
+        const Value undef = { 0, Value::UNDEF };
+        m_machine.m_functions.push_back( { static_cast< u32 >( arity ), undef, undef, {} } );
+        const auto index = static_cast< u32 >( m_machine.m_functions.size() - 1 );
+        m_functions.emplace( definition, index );
+        return index;
+    }
+
+    /**
+       starts the frame of a rule or derived definition, returns the amount
+       of parameters
+    */
+    template < typename Parameters >
+    u32 begin( Parameters& parameters )
+    {
+        m_locals.clear();
+        m_count = 0;
+        for( const auto& parameter : parameters )
+        {
+            declare( *parameter );
+        }
+        return m_count;
+    }
+
+    u32 declare( const Ast::Node& variable )
+    {
+        m_locals[ &variable ] = m_count;
+        return m_count++;
+    }
+
+  private:
+    Machine& m_machine;
+    Ast::Node* m_expected;
+    u32 m_result;
+    std::unordered_map< const Ast::Node*, u32 > m_routines;
+    std::unordered_map< const Ast::Node*, u32 > m_functions;
+    std::unordered_map< std::string, u32 > m_rules;
+    std::unordered_map< const Ast::Node*, u32 > m_locals;
+    u32 m_count;
+    std::vector< std::pair< u32, std::string > > m_references;
+    std::string m_init;
+};
+
+//
+//
+// Machine
+//
+
+i64 Machine::Value::integer( void ) const
+{
+    if( kind != INTEGER )
+    {
+        unsupported( "undefined integer operand" );
+    }
+    return data;
+}
+
+u1 Machine::Value::boolean( void ) const
+{
+    if( kind != BOOLEAN )
+    {
+        unsupported( "undefined boolean operand" );
+    }
+    return data != 0;
+}
+
+Machine::Machine( void )
+: m_program()
+, m_operands()
+, m_strings()
+, m_routines()
+, m_functions()
+, m_initializers()
+, m_main( 0 )
+, m_context()
+, m_rule( -1 )
+, m_steps( 0 )
+, m_restored( false )
+, m_workers( 1 )
+, m_threshold( PARALLEL_THRESHOLD )
+, m_pool()
+, m_chunks()
+, m_reason()
+{
+    m_context.base = 0;
+    m_context.depth = 0;
+    m_context.visible = 0;
+    m_context.parent = nullptr;
+    m_context.inherited = 0;
+    m_context.failed = false;
+}
+
+void Machine::setParallel( const std::size_t workers, const u64 threshold )
+{
+    m_workers = workers > 0 ? workers : ThreadPool::concurrency();
+    m_threshold = std::max< u64 >( threshold, 1 );
+}
+
+u1 Machine::compile( const libpass::PassResult& analysis )
+{
+    if( not analysis.hasOutput< ConsistencyCheckPass >() )
+    {
+        m_reason = "the specification is inconsistent";
+        return false;
+    }
+
+    try
+    {
+        Compiler compiler( *this );
+        const auto& data = analysis.output< ConsistencyCheckPass >();
+        compiler.compile( *data->specification() );
+    }
+    catch( const Unsupported& unsupported )
+    {
+        m_reason = unsupported.reason;
+        return false;
+    }
+
+    return true;
+}
+
+u1 Machine::run( const std::function< void( u64 ) >& handler )
+{
+    try
+    {
+        if( not m_restored )
+        {
+            for( const auto index : m_initializers )
+            {
+                const auto& instruction = m_program[ index ];
+                store(
+                    locate( m_context, instruction ), evaluate( m_context, instruction.third ) );
+            }
+            m_rule = m_main;
+        }
+
+        while( m_rule >= 0 )
+        {
+            if( handler )
+            {
+                handler( m_steps );
+            }
+            step();
+            m_steps++;
+        }
+    }
+    catch( const Unsupported& unsupported )
+    {
+        m_reason = unsupported.reason;
+        return false;
+    }
+
+    return true;
+}
+
+Snapshot Machine::snapshot( void ) const
+{
+    Snapshot::State state = { m_steps, m_rule, m_context.output, {} };
+    for( const auto& function : m_functions )
+    {
+        Snapshot::Table table = { function.arity, {} };
+        if( function.arity == 0 )
+        {
+            table.entries.push_back( { 0, 0, function.value.data, function.value.kind } );
+        }
+        for( const auto& entry : function.table )
+        {
+            table.entries.push_back(
+                { entry.first.first, entry.first.second, entry.second.data, entry.second.kind } );
+        }
+        state.tables.emplace_back( std::move( table ) );
+    }
+    return Snapshot( std::move( state ) );
+}
+
+u1 Machine::restore( const Snapshot& snapshot )
+{
+    Snapshot::State state;
+    if( not snapshot.decode( state ) or state.tables.size() != m_functions.size() or
+        state.rule >= static_cast< i64 >( m_routines.size() ) )
+    {
+        return false;
+    }
+
+    for( std::size_t index = 0; index < m_functions.size(); index++ )
+    {
+        const auto& table = state.tables[ index ];
+        if( table.arity != m_functions[ index ].arity or
+            ( table.arity == 0 and table.entries.size() != 1 ) )
+        {
+            return false;
+        }
+        for( const auto& entry : table.entries )
+        {
+            if( entry.kind > Value::RULE )
+            {
+                return false;
+            }
+        }
+    }
+
+    for( std::size_t index = 0; index < m_functions.size(); index++ )
+    {
+        auto& function = m_functions[ index ];
+        function.table.clear();
+        for( const auto& entry : state.tables[ index ].entries )
+        {
+            const Value value = { entry.data, static_cast< Value::Kind >( entry.kind ) };
+            if( function.arity == 0 )
+            {
+                function.value = value;
+            }
+            else
+            {
+                function.table[ { entry.first, entry.second } ] = value;
+            }
+        }
+    }
+
+    m_context.output = std::move( state.output );
+    m_rule = state.rule;
+    m_steps = state.step;
+    m_restored = true;
+    return true;
+}
+
+const std::string& Machine::output( void ) const
+{
+    return m_context.output;
+}
+
+u64 Machine::steps( void ) const
+{
+    return m_steps;
+}
+
+const std::string& Machine::reason( void ) const
+{
+    return m_reason;
+}
+
+Machine::Value Machine::evaluate( Context& context, const u32 index )
+{
+    const auto& instruction = m_program[ index ];
+
+    switch( instruction.op )
+    {
+        case Op::CONSTANT:
+        {
+            return { instruction.value, static_cast< Value::Kind >( instruction.kind ) };
+        }
+        case Op::LOCAL:
+        {
+            return context.locals[ context.base + instruction.value ];
+        }
+        case Op::LOOKUP:
+        {
+            return lookup( context, locate( context, instruction ) );
+        }
+        case Op::DERIVED:
+        {
+            const auto caller = enter( context, instruction );
+            const auto result = evaluate( context, m_routines[ instruction.value ].entry );
+            leave( context, caller );
+            return result;
+        }
+        case Op::SELECT:
+        {
+            const auto condition = evaluate( context, instruction.first ).boolean();
+            return evaluate( context, condition ? instruction.second : instruction.third );
+        }
+        case Op::NOT:
+        {
+            const auto operand = evaluate( context, instruction.first );
+            if( operand.kind == Value::UNDEF )
+            {
+                return operand;
+            }
+            return { not operand.boolean(), Value::BOOLEAN };
+        }
+        case Op::INV:
+        {
+            const auto operand = evaluate( context, instruction.first );
+            if( operand.kind == Value::UNDEF )
+            {
+                return operand;
+            }
+            return { subtract( 0, operand.integer() ), Value::INTEGER };
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    const auto lhs = evaluate( context, instruction.first );
+    const auto rhs = evaluate( context, instruction.second );
+
+    // an undefined operand yields undef as in the libcasm-ir operators, only
+    // equality compares it and the logical operators decide without it if the
+    // defined operand is sufficient
+    const auto undefined = lhs.kind == Value::UNDEF or rhs.kind == Value::UNDEF;
+    switch( instruction.op )
+    {
+        case Op::EQU:
+        case Op::NEQ:
+        {
+            break;
+        }
+        case Op::AND:
+        case Op::IMP:
+        {
+            if( ( lhs.kind == Value::BOOLEAN and not lhs.data ) or
+                ( rhs.kind == Value::BOOLEAN and not rhs.data and instruction.op == Op::AND ) )
+            {
+                return { instruction.op == Op::AND ? false : true, Value::BOOLEAN };
+            }
+            if( instruction.op == Op::IMP and rhs.kind == Value::BOOLEAN and rhs.data )
+            {
+                return { true, Value::BOOLEAN };
+            }
+            if( undefined )
+            {
+                return { 0, Value::UNDEF };
+            }
+            break;
+        }
+        case Op::OR:
+        {
+            if( ( lhs.kind == Value::BOOLEAN and lhs.data ) or
+                ( rhs.kind == Value::BOOLEAN and rhs.data ) )
+            {
+                return { true, Value::BOOLEAN };
+            }
+            if( undefined )
+            {
+                return { 0, Value::UNDEF };
+            }
+            break;
+        }
+        default:
+        {
+            if( undefined )
+            {
+                return { 0, Value::UNDEF };
+            }
+            break;
+        }
+    }
+
+    switch( instruction.op )
+    {
+        case Op::ADD:
+        {
+            return { add( lhs.integer(), rhs.integer() ), Value::INTEGER };
+        }
+        case Op::SUB:
+        {
+            return { subtract( lhs.integer(), rhs.integer() ), Value::INTEGER };
+        }
+        case Op::MUL:
+        {
+            return { multiply( lhs.integer(), rhs.integer() ), Value::INTEGER };
+        }
+        case Op::DIV:
+        {
+            divisible( lhs.integer(), rhs.integer() );
+            return { lhs.data / rhs.data, Value::INTEGER };
+        }
+        case Op::MOD:
+        {
+            divisible( lhs.integer(), rhs.integer() );
+            return { lhs.data % rhs.data, Value::INTEGER };
+        }
+        case Op::POW:
+        {
+            return { power( lhs.integer(), rhs.integer() ), Value::INTEGER };
+        }
+        case Op::EQU:
+        {
+            return { lhs == rhs, Value::BOOLEAN };
+        }
+        case Op::NEQ:
+        {
+            return { not( lhs == rhs ), Value::BOOLEAN };
+        }
+        case Op::LTH:
+        {
+            return { lhs.integer() < rhs.integer(), Value::BOOLEAN };
+        }
+        case Op::LEQ:
+        {
+            return { lhs.integer() <= rhs.integer(), Value::BOOLEAN };
+        }
+        case Op::GTH:
+        {
+            return { lhs.integer() > rhs.integer(), Value::BOOLEAN };
+        }
+        case Op::GEQ:
+        {
+            return { lhs.integer() >= rhs.integer(), Value::BOOLEAN };
+        }
+        case Op::AND:
+        {
+            return { lhs.boolean() and rhs.boolean(), Value::BOOLEAN };
+        }
+        case Op::OR:
+        {
+            return { lhs.boolean() or rhs.boolean(), Value::BOOLEAN };
+        }
+        case Op::XOR:
+        {
+            return { lhs.boolean() != rhs.boolean(), Value::BOOLEAN };
+        }
+        case Op::IMP:
+        {
+            return { not lhs.boolean() or rhs.boolean(), Value::BOOLEAN };
+        }
+        default:
+        {
+            unsupported( "instruction is not a value" );
+        }
+    }
+}
+
+void Machine::text( Context& context, const u32 index, std::string& text )
+{
+    const auto& instruction = m_program[ index ];
+
+    switch( instruction.op )
+    {
+        case Op::TEXT:
+        {
+            text += m_strings[ instruction.value ];
+            break;
+        }
+        case Op::CONCAT:
+        {
+            this->text( context, instruction.first, text );
+            this->text( context, instruction.second, text );
+            break;
+        }
+        case Op::FORMAT:
+        {
+            const auto value = evaluate( context, instruction.first );
+            if( value.kind == Value::INTEGER )
+            {
+                text += std::to_string( value.data );
+            }
+            else if( value.kind == Value::BOOLEAN )
+            {
+                text += value.data ? "true" : "false";
+            }
+            else
+            {
+                unsupported( "text of an undefined value" );
+            }
+            break;
+        }
+        default:
+        {
+            unsupported( "instruction is not a text" );
+        }
+    }
+}
+
+template < typename Body >
+void Machine::iterate( Context& context, const u64 count, const Body& body )
+{
+    // the chunks of a parallel evaluation are not divided again
+    if( m_workers <= 1 or count < m_threshold or context.parent )
+    {
+        for( u64 index = 0; index < count; index++ )
+        {
+            body( context, index );
+        }
+        return;
+    }
+
+    if( not m_pool )
+    {
+        m_pool.reset( new ThreadPool( m_workers ) );
+    }
+
+    // a few chunks per worker balance chunks of different costs, the
+    // partition does not change the result
+    const auto chunks = std::min< u64 >( m_workers * 4, ( count + m_threshold - 1 ) / m_threshold );
+    const auto size = ( count + chunks - 1 ) / chunks;
+    if( m_chunks.size() < chunks )
+    {
+        m_chunks.resize( chunks );
+    }
+
+    for( u64 index = 0; index < chunks; index++ )
+    {
+        auto& chunk = m_chunks[ index ];
+        chunk.locals.assign( context.locals.begin() + context.base, context.locals.end() );
+        chunk.base = 0;
+        chunk.depth = 0;
+        chunk.visible = context.visible;
+        chunk.output.clear();
+        chunk.parent = &context;
+        chunk.inherited = context.depth;
+        chunk.reason.clear();
+        chunk.failed = false;
+        push( chunk, false );
+
+        const auto begin = index * size;
+        const auto end = std::min( count, begin + size );
+        m_pool->submit( [this, &chunk, &body, begin, end]() {
+            try
+            {
+                for( auto element = begin; element < end; element++ )
+                {
+                    body( chunk, element );
+                }
+                check( chunk );
+            }
+            catch( const Unsupported& unsupported )
+            {
+                chunk.reason = unsupported.reason;
+                chunk.failed = true;
+            }
+            catch( const std::exception& e )
+            {
+                chunk.reason = e.what();
+                chunk.failed = true;
+            }
+        } );
+    }
+    m_pool->wait();
+
+    // the chunks are merged in their order, the conflicts between them are
+    // detected by the check of the enclosing layer
+    auto& updates = context.layers[ context.depth - 1 ].updates;
+    for( u64 index = 0; index < chunks; index++ )
+    {
+        auto& chunk = m_chunks[ index ];
+        if( chunk.failed )
+        {
+            unsupported( chunk.reason );
+        }
+
+        const auto& collected = chunk.layers[ 0 ].updates;
+        updates.insert( updates.end(), collected.begin(), collected.end() );
+        context.output += chunk.output;
+        pop( chunk );
+    }
+}
+
+void Machine::execute( Context& context, const u32 index )
+{
+    const auto& instruction = m_program[ index ];
+
+    switch( instruction.op )
+    {
+        case Op::SKIP:
+        {
+            break;
+        }
+        case Op::BLOCK:
+        {
+            iterate( context, instruction.second, [&]( Context& context, const u64 operand ) {
+                execute( context, m_operands[ instruction.first + operand ] );
+            } );
+            break;
+        }
+        case Op::SEQUENCE:
+        {
+            // the updates of a finished rule are visible to the next ones and
+            // override the updates of the previous ones
+            push( context, true );
+            const auto sequence = context.depth - 1;
+            for( u32 operand = 0; operand < instruction.second; operand++ )
+            {
+                push( context, false );
+                execute( context, m_operands[ instruction.first + operand ] );
+                check( context );
+
+                const auto& previous = context.layers[ sequence ].updates;
+                const auto& current = context.layers[ sequence + 1 ].updates;
+                context.merged.clear();
+                std::size_t lhs = 0;
+                std::size_t rhs = 0;
+                while( lhs < previous.size() or rhs < current.size() )
+                {
+                    if( rhs == current.size() or
+                        ( lhs < previous.size() and
+                          previous[ lhs ].location < current[ rhs ].location ) )
+                    {
+                        context.merged.push_back( previous[ lhs++ ] );
+                        continue;
+                    }
+                    if( lhs < previous.size() and
+                        previous[ lhs ].location == current[ rhs ].location )
+                    {
+                        lhs++;
+                    }
+                    context.merged.push_back( current[ rhs++ ] );
+                }
+                context.layers[ sequence ].updates.swap( context.merged );
+                pop( context );
+            }
+
+            const auto& updates = context.layers[ sequence ].updates;
+            auto& parent = context.layers[ sequence - 1 ].updates;
+            parent.insert( parent.end(), updates.begin(), updates.end() );
+            pop( context );
+            break;
+        }
+        case Op::CONDITIONAL:
+        {
+            const auto condition = evaluate( context, instruction.first ).boolean();
+            execute( context, condition ? instruction.second : instruction.third );
+            break;
+        }
+        case Op::LET:
+        {
+            const auto value = evaluate( context, instruction.first );
+            context.locals[ context.base + instruction.value ] = value;
+            execute( context, instruction.second );
+            break;
+        }
+        case Op::FORALL:
+        {
+            const auto& range = m_program[ instruction.first ];
+            const auto from = evaluate( context, range.first ).integer();
+            const auto to = evaluate( context, range.second ).integer();
+            if( from > to )
+            {
+                break;
+            }
+
+            // the amount of elements of the full 64-bit range is not
+            // representable
+            const auto count = static_cast< u64 >( to ) - static_cast< u64 >( from ) + 1;
+            if( count == 0 )
+            {
+                unsupported( "forall over the full integer range" );
+            }
+
+            iterate( context, count, [&]( Context& context, const u64 offset ) {
+                const auto element = static_cast< i64 >( static_cast< u64 >( from ) + offset );
+                context.locals[ context.base + instruction.value ] = { element, Value::INTEGER };
+                execute( context, instruction.second );
+            } );
+            break;
+        }
+        case Op::UPDATE:
+        {
+            const auto location = locate( context, instruction );
+            const auto value = evaluate( context, instruction.third );
+            context.layers[ context.depth - 1 ].updates.push_back( { location, value } );
+            break;
+        }
+        case Op::PROGRAM:
+        {
+            const auto value = evaluate( context, instruction.first );
+            const Location location = { PROGRAM_FUNCTION, 0, 0 };
+            context.layers[ context.depth - 1 ].updates.push_back( { location, value } );
+            break;
+        }
+        case Op::CALL:
+        {
+            const auto caller = enter( context, instruction );
+            execute( context, m_routines[ instruction.value ].entry );
+            leave( context, caller );
+            break;
+        }
+        case Op::PRINT:
+        {
+            text( context, instruction.first, context.output );
+            if( instruction.value )
+            {
+                context.output += '\n';
+            }
+            break;
+        }
+        default:
+        {
+            unsupported( "instruction is not a rule" );
+        }
+    }
+}
+
+std::size_t Machine::enter( Context& context, const Instruction& instruction )
+{
+    const auto& routine = m_routines[ instruction.value ];
+    const auto base = context.locals.size();
+    context.locals.resize( base + routine.locals, { 0, Value::UNDEF } );
+
+    // the arguments are evaluated in the frame of the caller
+    for( u32 operand = 0; operand < instruction.second; operand++ )
+    {
+        const auto argument = evaluate( context, m_operands[ instruction.first + operand ] );
+        context.locals[ base + operand ] = argument;
+    }
+
+    const auto caller = context.base;
+    context.base = base;
+    return caller;
+}
+
+void Machine::leave( Context& context, const std::size_t caller )
+{
+    context.locals.resize( context.base );
+    context.base = caller;
+}
+
+Machine::Location Machine::locate( Context& context, const Instruction& instruction )
+{
+    Location location = { static_cast< u32 >( instruction.value ), 0, 0 };
+    for( u32 operand = 0; operand < instruction.second; operand++ )
+    {
+        const auto argument = evaluate( context, m_operands[ instruction.first + operand ] );
+        if( argument.kind == Value::UNDEF )
+        {
+            unsupported( "undefined function argument" );
+        }
+        ( operand == 0 ? location.first : location.second ) = argument.data;
+    }
+    return location;
+}
+
+Machine::Value Machine::lookup( const Context& context, const Location& location ) const
+{
+    // only sequences make updates visible before the end of the step, a
+    // chunk sees the ones of its forking context as well
+    if( context.visible > 0 )
+    {
+        auto layers = &context;
+        auto depth = context.depth;
+        while( layers )
+        {
+            while( depth-- > 0 )
+            {
+                const auto& layer = layers->layers[ depth ];
+                if( not layer.visible )
+                {
+                    continue;
+                }
+
+                const auto update = std::lower_bound(
+                    layer.updates.begin(), layer.updates.end(), location,
+                    []( const Update& update, const Location& location ) {
+                        return update.location < location;
+                    } );
+                if( update != layer.updates.end() and update->location == location )
+                {
+                    return update->value;
+                }
+            }
+
+            depth = layers->inherited;
+            layers = layers->parent;
+        }
+    }
+
+    const auto& function = m_functions[ location.function ];
+    if( function.arity == 0 )
+    {
+        return function.value;
+    }
+
+    const auto entry = function.table.find( { location.first, location.second } );
+    return entry != function.table.end() ? entry->second : function.fallback;
+}
+
+void Machine::store( const Location& location, const Value& value )
+{
+    if( location.function == PROGRAM_FUNCTION )
+    {
+        m_rule = value.kind == Value::RULE ? value.data : -1;
+        return;
+    }
+
+    auto& function = m_functions[ location.function ];
+    if( function.arity == 0 )
+    {
+        function.value = value;
+    }
+    else
+    {
+        function.table[ { location.first, location.second } ] = value;
+    }
+}
+
+void Machine::push( Context& context, const u1 visible )
+{
+    if( context.depth == context.layers.size() )
+    {
+        context.layers.emplace_back();
+    }
+
+    auto& layer = context.layers[ context.depth++ ];
+    layer.updates.clear();
+    layer.visible = visible;
+    if( visible )
+    {
+        context.visible++;
+    }
+}
+
+void Machine::pop( Context& context )
+{
+    context.depth--;
+    if( context.layers[ context.depth ].visible )
+    {
+        context.visible--;
+    }
+}
+
+void Machine::check( Context& context )
+{
+    auto& updates = context.layers[ context.depth - 1 ].updates;
+    if( updates.size() < 2 )
+    {
+        return;
+    }
+
+    // the chunks of a forall over a table are usually appended in order
+    const auto order = []( const Update& lhs, const Update& rhs ) {
+        return lhs.location < rhs.location;
+    };
+    if( not std::is_sorted( updates.begin(), updates.end(), order ) )
+    {
+        std::sort( updates.begin(), updates.end(), order );
+    }
+
+    std::size_t count = 0;
+    for( std::size_t index = 0; index < updates.size(); index++ )
+    {
+        if( count > 0 and updates[ count - 1 ].location == updates[ index ].location )
+        {
+            if( not( updates[ count - 1 ].value == updates[ index ].value ) )
+            {
+                unsupported( "conflicting updates" );
+            }
+            continue;
+        }
+        updates[ count++ ] = updates[ index ];
+    }
+    updates.resize( count );
+}
+
+void Machine::step( void )
+{
+    auto& context = m_context;
+    const auto& routine = m_routines[ m_rule ];
+    context.locals.assign( routine.locals, { 0, Value::UNDEF } );
+    context.base = 0;
+
+    push( context, false );
+    execute( context, routine.entry );
+    check( context );
+    for( const auto& update : context.layers[ context.depth - 1 ].updates )
+    {
+        store( update.location, update.value );
+    }
+    pop( context );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,408 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_MACHINE_H_
+#define _CASMD_MACHINE_H_
+
+/**
+   @brief    flat execution backend of a checked specification
+
+   The machine lowers the AST of the consistency check to a flat program:
+   one contiguous array of instructions with operand indices instead of
+   pointers.  The program is casmd's own instruction format, it is not
+   produced by libcasm-ir, only the operator opcodes are taken from the
+   libcasm-ir instruction kinds the type check resolved.  Calls,
+   functions and local variables are resolved to slots while lowering,
+   therefore a step performs no symbol or string lookups.  Controlled
+   functions are stored densely per slot, and the updates of a step are
+   collected in flat vectors which are sorted once to detect conflicts.
+
+   The machine covers the sequential subset of the language (blocks,
+   sequences, conditionals, let, forall over integer ranges, updates, rule
+   and derived calls, print) on integer, boolean and undefined values.  The
+   operators propagate undef like the libcasm-ir ones: arithmetic and
+   ordering yield undef, equality compares it, and the logical operators
+   decide without it if the defined operand suffices.  A construct outside
+   of the subset is reported by 'compile', and every execution which would
+   leave it (an integer overflow, an undefined condition, range or function
+   argument, printing undef, an update conflict, ...) is aborted by 'run'.
+   In both cases the caller executes the specification with the AST
+   interpreter instead, which reports the exact diagnostics.
+
+   The state at a step boundary (function tables, step counter, current
+   rule and output) is taken as a serialized 'Snapshot', and a machine
+   compiled from the same specification continues from it.
+
+   With several workers the iterations of a forall rule and the rules of a
+   block are evaluated in chunks on a work-stealing pool once their amount
+   reaches the threshold.  Every chunk runs in its own context with its own
+   update set and output, the update sets are appended in chunk order and
+   conflict-checked with the other updates of the step, the output is
+   appended in iteration order.  The result is therefore the one of the
+   sequential evaluation.  Nested parallel rules of a chunk are evaluated
+   sequentially.
+*/
+
+#include "Snapshot.h"
+#include "ThreadPool.h"
+
+#include <libpass/PassResult>
+#include <libstdhl/Type>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u8 = libstdhl::u8;
+    using u32 = libstdhl::u32;
+    using i64 = libstdhl::i64;
+    using u64 = libstdhl::u64;
+
+    class Machine
+    {
+      public:
+        /**
+           minimum amount of iterations or rules of a parallel evaluation
+        */
+        static constexpr u64 PARALLEL_THRESHOLD = 256;
+
+        Machine( void );
+
+        /**
+           evaluates large forall rules and blocks on 'workers' threads, zero
+           selects the amount of hardware threads and one the sequential
+           evaluation (the default).  The pool is created at the first
+           parallel evaluation
+        */
+        void setParallel( const std::size_t workers, const u64 threshold = PARALLEL_THRESHOLD );
+
+        /**
+           lowers the consistency checked specification of 'analysis',
+           returns 'false' if it uses a construct outside of the subset
+        */
+        u1 compile( const libpass::PassResult& analysis );
+
+        /**
+           executes the compiled program until the program function is
+           undefined, 'handler' is called with the amount of completed steps
+           before every step.  Returns 'false' if the execution left the
+           subset, the output is incomplete then
+        */
+        u1 run( const std::function< void( u64 ) >& handler );
+
+        /**
+           state at the current step boundary, called by the step handler
+        */
+        Snapshot snapshot( void ) const;
+
+        /**
+           continues the next 'run' from 'snapshot' instead of the initial
+           state, returns 'false' if the function tables of the snapshot do
+           not match the compiled program
+        */
+        u1 restore( const Snapshot& snapshot );
+
+        const std::string& output( void ) const;
+
+        u64 steps( void ) const;
+
+        /**
+           why the specification was not compiled or the execution aborted
+        */
+        const std::string& reason( void ) const;
+
+      private:
+        class Compiler;
+
+        enum class Op : u8
+        {
+            // expressions
+            CONSTANT,
+            LOCAL,
+            LOOKUP,
+            DERIVED,
+            SELECT,
+            RANGE,
+            NOT,
+            INV,
+            ADD,
+            SUB,
+            MUL,
+            DIV,
+            MOD,
+            POW,
+            EQU,
+            NEQ,
+            LTH,
+            LEQ,
+            GTH,
+            GEQ,
+            AND,
+            OR,
+            XOR,
+            IMP,
+
+            // string expressions of the printed text
+            TEXT,
+            CONCAT,
+            FORMAT,
+
+            // rules
+            SKIP,
+            BLOCK,
+            SEQUENCE,
+            CONDITIONAL,
+            LET,
+            FORALL,
+            UPDATE,
+            PROGRAM,
+            CALL,
+            PRINT,
+        };
+
+        /**
+           'first', 'second' and 'third' are instruction indices, or the
+           offset and count of an operand list, 'value' holds slots and
+           constants
+        */
+        struct Instruction
+        {
+            Op op;
+            u8 kind;
+            u32 first;
+            u32 second;
+            u32 third;
+            i64 value;
+        };
+
+        struct Routine
+        {
+            u32 entry;
+            u32 parameters;
+            u32 locals;
+        };
+
+        struct Value
+        {
+            enum Kind : u8
+            {
+                UNDEF = 0,
+                INTEGER,
+                BOOLEAN,
+                RULE,
+            };
+
+            i64 data;
+            Kind kind;
+
+            u1 operator==( const Value& other ) const
+            {
+                return kind == other.kind and data == other.data;
+            }
+
+            /**
+               data of an integer, aborts the execution for other values
+            */
+            i64 integer( void ) const;
+
+            /**
+               data of a boolean, aborts the execution for other values
+            */
+            u1 boolean( void ) const;
+        };
+
+        struct Location
+        {
+            u32 function;
+            i64 first;
+            i64 second;
+
+            u1 operator==( const Location& other ) const
+            {
+                return function == other.function and first == other.first and
+                       second == other.second;
+            }
+
+            u1 operator<( const Location& other ) const
+            {
+                return function < other.function or
+                       ( function == other.function and
+                         ( first < other.first or
+                           ( first == other.first and second < other.second ) ) );
+            }
+        };
+
+        struct Update
+        {
+            Location location;
+            Value value;
+        };
+
+        struct Layer
+        {
+            std::vector< Update > updates;
+            u1 visible;
+        };
+
+        struct Key
+        {
+            i64 first;
+            i64 second;
+
+            u1 operator==( const Key& other ) const
+            {
+                return first == other.first and second == other.second;
+            }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()( const Key& key ) const
+            {
+                return std::hash< i64 >()( key.first * 0x9e3779b97f4a7c15 ^ key.second );
+            }
+        };
+
+        /**
+           mutable state of an evaluation, the step runs in the context of
+           the machine and every chunk of a parallel evaluation in its own
+        */
+        struct Context
+        {
+            std::vector< Value > locals;
+            std::size_t base;
+            std::vector< Layer > layers;
+            std::size_t depth;
+
+            // visible layers incl. the inherited ones
+            std::size_t visible;
+
+            std::vector< Update > merged;
+            std::string output;
+
+            // forking context and the amount of its layers which are
+            // visible to the chunk
+            const Context* parent;
+            std::size_t inherited;
+
+            // why the evaluation of a chunk was aborted
+            std::string reason;
+            u1 failed;
+        };
+
+        struct Function
+        {
+            u32 arity;
+
+            // location of a nullary function
+            Value value;
+
+            // value of the locations of a table which are not updated yet
+            Value fallback;
+
+            std::unordered_map< Key, Value, KeyHash > table;
+        };
+
+      private:
+        Value evaluate( Context& context, const u32 index );
+
+        void text( Context& context, const u32 index, std::string& text );
+
+        void execute( Context& context, const u32 index );
+
+        /**
+           calls 'body' with the indices below 'count', in chunks on the pool
+           if the evaluation is parallel
+        */
+        template < typename Body >
+        void iterate( Context& context, const u64 count, const Body& body );
+
+        /**
+           binds the arguments of a rule or derived call in a new frame,
+           returns the base of the calling frame
+        */
+        std::size_t enter( Context& context, const Instruction& instruction );
+
+        void leave( Context& context, const std::size_t caller );
+
+        Location locate( Context& context, const Instruction& instruction );
+
+        Value lookup( const Context& context, const Location& location ) const;
+
+        void store( const Location& location, const Value& value );
+
+        void push( Context& context, const u1 visible );
+
+        void pop( Context& context );
+
+        /**
+           sorts the updates of the top layer by location and removes equal
+           updates, conflicting ones abort the execution
+        */
+        void check( Context& context );
+
+        void step( void );
+
+      private:
+        std::vector< Instruction > m_program;
+        std::vector< u32 > m_operands;
+        std::vector< std::string > m_strings;
+        std::vector< Routine > m_routines;
+        std::vector< Function > m_functions;
+        // updates of the initial state
+        std::vector< u32 > m_initializers;
+        u32 m_main;
+
+        Context m_context;
+        i64 m_rule;
+        u64 m_steps;
+        u1 m_restored;
+
+        std::size_t m_workers;
+        u64 m_threshold;
+        std::unique_ptr< ThreadPool > m_pool;
+
+        // contexts of the chunks of the current parallel evaluation
+        std::vector< Context > m_chunks;
+
+        std::string m_reason;
+    };
+}
+
+#endif  // _CASMD_MACHINE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,261 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "OccurrenceIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <unordered_set>
+
+using namespace casmd;
+
+void OccurrenceIndex::update(
+    const std::string& uri,
+    const std::string& text,
+    const LineIndex& lines,
+    const std::vector< SemanticTokens::Token >& tokens )
+{
+    remove( uri );
+
+    std::vector< Entry > entries;
+    for( const auto& token : tokens )
+    {
+        if( token.type == SemanticTokens::KEYWORD or token.type == SemanticTokens::VARIABLE or
+            ( token.modifiers & SemanticTokens::DEFAULT_LIBRARY ) or token.line >= lines.lines() )
+        {
+            continue;
+        }
+
+        const auto begin = lines.offset( text, { token.line, token.character } );
+        const auto end = lines.offset( text, { token.line, token.character + token.length } );
+        if( begin == end )
+        {
+            continue;
+        }
+
+        const Occurrence occurrence = { token.line,
+                                        token.character,
+                                        token.length,
+                                        ( token.modifiers & SemanticTokens::DECLARATION ) != 0 };
+        entries.push_back( { text.substr( begin, end - begin ), occurrence } );
+        m_symbols[ entries.back().name ][ uri ].push_back( occurrence );
+    }
+
+    if( not entries.empty() )
+    {
+        m_documents.emplace( uri, std::move( entries ) );
+    }
+}
+
+void OccurrenceIndex::remove( const std::string& uri )
+{
+    const auto document = m_documents.find( uri );
+    if( document == m_documents.end() )
+    {
+        return;
+    }
+
+    for( const auto& entry : document->second )
+    {
+        const auto symbol = m_symbols.find( entry.name );
+        if( symbol == m_symbols.end() )
+        {
+            continue;
+        }
+
+        symbol->second.erase( uri );
+        if( symbol->second.empty() )
+        {
+            m_symbols.erase( symbol );
+        }
+    }
+
+    m_documents.erase( document );
+}
+
+std::string OccurrenceIndex::symbol(
+    const std::string& uri, const u32 line, const u32 character ) const
+{
+    const auto document = m_documents.find( uri );
+    if( document == m_documents.end() )
+    {
+        return "";
+    }
+
+    // the last occurrence starting at or before the position, the position
+    // right after an identifier still selects it
+    const auto& entries = document->second;
+    const auto next = std::upper_bound(
+        entries.begin(), entries.end(), std::make_pair( line, character ),
+        []( const std::pair< u32, u32 >& position, const Entry& entry ) {
+            return position.first < entry.occurrence.line or
+                   ( position.first == entry.occurrence.line and
+                     position.second < entry.occurrence.character );
+        } );
+    if( next == entries.begin() )
+    {
+        return "";
+    }
+
+    const auto& entry = *( next - 1 );
+    if( entry.occurrence.line != line or
+        character > entry.occurrence.character + entry.occurrence.length )
+    {
+        return "";
+    }
+
+    return entry.name;
+}
+
+OccurrenceIndex::Occurrences OccurrenceIndex::references(
+    const std::string& uri, const std::string& name, const DependencyGraph& dependencies ) const
+{
+    Occurrences references;
+
+    const auto symbol = m_symbols.find( name );
+    if( symbol == m_symbols.end() )
+    {
+        return references;
+    }
+
+    std::vector< std::string > scope;
+    const auto declaring = declaration( uri, name, dependencies );
+    if( declaring.empty() )
+    {
+        scope.emplace_back( uri );
+    }
+    else
+    {
+        scope.emplace_back( declaring );
+        for( const auto& level : dependencies.dependents( declaring ) )
+        {
+            scope.insert( scope.end(), level.begin(), level.end() );
+        }
+    }
+
+    for( const auto& document : scope )
+    {
+        const auto occurrences = symbol->second.find( document );
+        if( occurrences != symbol->second.end() )
+        {
+            references.emplace( *occurrences );
+        }
+    }
+
+    return references;
+}
+
+std::string OccurrenceIndex::declaration(
+    const std::string& uri, const std::string& name, const DependencyGraph& dependencies ) const
+{
+    const auto symbol = m_symbols.find( name );
+    if( symbol == m_symbols.end() )
+    {
+        return "";
+    }
+
+    // breadth-first, a declaration of the document itself or of a closer
+    // import shadows the ones of farther imports
+    std::unordered_set< std::string > visited = { uri };
+    std::deque< std::string > pending = { uri };
+
+    while( not pending.empty() )
+    {
+        const auto document = pending.front();
+        pending.pop_front();
+
+        const auto occurrences = symbol->second.find( document );
+        if( occurrences != symbol->second.end() )
+        {
+            for( const auto& occurrence : occurrences->second )
+            {
+                if( occurrence.declaration )
+                {
+                    return document;
+                }
+            }
+        }
+
+        for( const auto& import : dependencies.imports( document ) )
+        {
+            if( visited.emplace( import ).second )
+            {
+                pending.emplace_back( import );
+            }
+        }
+    }
+
+    return "";
+}
+
+u1 OccurrenceIndex::identifier( const std::string& name )
+{
+    if( name.empty() or std::isdigit( static_cast< unsigned char >( name.front() ) ) )
+    {
+        return false;
+    }
+
+    for( const auto c : name )
+    {
+        if( not( std::isalnum( static_cast< unsigned char >( c ) ) or c == '_' ) )
+        {
+            return false;
+        }
+    }
+
+    std::vector< SemanticTokens::Token > keywords;
+    SemanticTokens::scan( name, keywords );
+    return keywords.empty();
+}
+
+std::size_t OccurrenceIndex::size( void ) const
+{
+    return m_symbols.size();
+}
+
+std::size_t OccurrenceIndex::usage( void ) const
+{
+    std::size_t usage = 0;
+    for( const auto& document : m_documents )
+    {
+        usage += document.first.size() + document.second.capacity() * sizeof( Entry );
+        for( const auto& entry : document.second )
+        {
+            // the name of the entry and the copy of its occurrence per symbol
+            usage += entry.name.size() + sizeof( Occurrence );
+        }
+    }
+    return usage;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,140 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_OCCURRENCE_INDEX_H_
+#define _CASMD_OCCURRENCE_INDEX_H_
+
+/**
+   @brief    inverted index from the global symbols of a workspace to their
+             occurrences
+
+   The occurrences of the rules, functions, derived, enumerations and
+   enumerators of a document are taken from its semantic tokens once per
+   analyzed revision and replace the ones of the previous revision.  A
+   references, highlight or rename request is therefore a lookup of the
+   symbol name, restricted to the documents which share the defining
+   document by their imports.  Local variables and builtins are not
+   indexed.
+*/
+
+#include "DependencyGraph.h"
+#include "SemanticTokens.h"
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u32 = libstdhl::u32;
+
+    class OccurrenceIndex
+    {
+      public:
+        struct Occurrence
+        {
+            u32 line;
+            u32 character;
+            u32 length;
+            u1 declaration;
+        };
+
+        using Occurrences = std::unordered_map< std::string, std::vector< Occurrence > >;
+
+        /**
+           replaces the occurrences of 'uri' by the symbols of its semantic
+           'tokens', 'text' is the analyzed text of the tokens and 'lines'
+           its line index
+        */
+        void update(
+            const std::string& uri,
+            const std::string& text,
+            const LineIndex& lines,
+            const std::vector< SemanticTokens::Token >& tokens );
+
+        void remove( const std::string& uri );
+
+        /**
+           name of the indexed symbol at the position, or empty
+        */
+        std::string symbol( const std::string& uri, const u32 line, const u32 character ) const;
+
+        /**
+           occurrences of 'name' per document, restricted to the document
+           which declares the symbol for 'uri' and its transitive dependents;
+           an undeclared symbol is only looked up in 'uri'
+        */
+        Occurrences references(
+            const std::string& uri,
+            const std::string& name,
+            const DependencyGraph& dependencies ) const;
+
+        /**
+           'true' if 'name' is an identifier and not a keyword
+        */
+        static u1 identifier( const std::string& name );
+
+        std::size_t size( void ) const;
+
+        std::size_t usage( void ) const;
+
+      private:
+        struct Entry
+        {
+            std::string name;
+            Occurrence occurrence;
+        };
+
+        /**
+           document which declares 'name' for 'uri', searched in 'uri' and
+           its transitive imports, or empty
+        */
+        std::string declaration(
+            const std::string& uri,
+            const std::string& name,
+            const DependencyGraph& dependencies ) const;
+
+      private:
+        // occurrences of every document in the order of their position
+        std::unordered_map< std::string, std::vector< Entry > > m_documents;
+
+        // occurrences of every symbol per document
+        std::unordered_map< std::string, Occurrences > m_symbols;
+    };
+}
+
+#endif  // _CASMD_OCCURRENCE_INDEX_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,329 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Outline.h"
+
+#include "JsonWriter.h"
+#include "LineIndex.h"
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libcasm-fe/ast/RecursiveVisitor>
+
+#include <algorithm>
+#include <vector>
+
+using namespace casmd;
+using namespace libcasm_fe;
+
+// LSP 'SymbolKind' values
+static constexpr i64 SYMBOL_METHOD = 6;
+static constexpr i64 SYMBOL_ENUM = 10;
+static constexpr i64 SYMBOL_FUNCTION = 12;
+static constexpr i64 SYMBOL_ENUM_MEMBER = 22;
+
+namespace
+{
+    struct Range
+    {
+        i64 startLine;
+        i64 startCharacter;
+        i64 endLine;
+        i64 endCharacter;
+
+        /**
+           range of the one-based source location with byte columns, the
+           characters are encoded as UTF-16 code units of 'text'
+        */
+        template < typename Location >
+        static Range of(
+            const Location& location, const std::string& text, const LineIndex& lines )
+        {
+            const auto startLine = static_cast< u32 >( location.begin.line - 1 );
+            const auto endLine = static_cast< u32 >( location.end.line - 1 );
+            return { startLine,
+                     lines.character(
+                         text, startLine, static_cast< u32 >( location.begin.column - 1 ) ),
+                     endLine,
+                     lines.character(
+                         text, endLine, static_cast< u32 >( location.end.column - 1 ) ) };
+        }
+
+        void serialize( JsonWriter& json ) const
+        {
+            json.beginObject();
+            json.key( "start" ).beginObject();
+            json.key( "line" ).number( startLine );
+            json.key( "character" ).number( startCharacter );
+            json.endObject();
+            json.key( "end" ).beginObject();
+            json.key( "line" ).number( endLine );
+            json.key( "character" ).number( endCharacter );
+            json.endObject();
+            json.endObject();
+        }
+    };
+
+    struct Symbol
+    {
+        std::string name;
+        const char* detail;
+        i64 kind;
+        Range range;
+        Range selectionRange;
+        std::vector< Symbol > children;
+
+        void serialize( JsonWriter& json ) const
+        {
+            json.beginObject();
+            json.key( "name" ).string( name );
+            json.key( "detail" ).string( detail );
+            json.key( "kind" ).number( kind );
+            json.key( "range" );
+            range.serialize( json );
+            json.key( "selectionRange" );
+            selectionRange.serialize( json );
+            if( not children.empty() )
+            {
+                json.key( "children" ).beginArray();
+                for( const auto& child : children )
+                {
+                    child.serialize( json );
+                }
+                json.endArray();
+            }
+            json.endObject();
+        }
+    };
+
+    /**
+       collects the definitions as symbols and all multi-line definitions and
+       block rules as folding ranges
+    */
+    class OutlineVisitor final : public Ast::RecursiveVisitor
+    {
+      public:
+        OutlineVisitor( const std::string& text, const LineIndex& lines )
+        : m_text( text )
+        , m_lines( lines )
+        {
+        }
+
+        std::vector< Symbol > symbols;
+        std::vector< std::pair< i64, i64 > > folds;
+
+        void visit( Ast::FunctionDefinition& node ) override
+        {
+            define( node, "function", SYMBOL_FUNCTION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::DerivedDefinition& node ) override
+        {
+            define( node, "derived", SYMBOL_FUNCTION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::RuleDefinition& node ) override
+        {
+            define( node, "rule", SYMBOL_METHOD );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::EnumerationDefinition& node ) override
+        {
+            define( node, "enumeration", SYMBOL_ENUM );
+            m_enumeration = &symbols.back();
+            RecursiveVisitor::visit( node );
+            m_enumeration = nullptr;
+        }
+
+        void visit( Ast::EnumeratorDefinition& node ) override
+        {
+            if( m_enumeration )
+            {
+                m_enumeration->children.push_back( symbol( node, "", SYMBOL_ENUM_MEMBER ) );
+            }
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::BlockRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::SequenceRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::ConditionalRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::CaseRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::ForallRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::ChooseRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::LetRule& node ) override
+        {
+            fold( node );
+            RecursiveVisitor::visit( node );
+        }
+
+      private:
+        template < typename Definition >
+        Symbol symbol( Definition& node, const char* detail, const i64 kind ) const
+        {
+            return { node.identifier()->name(),
+                     detail,
+                     kind,
+                     Range::of( node.sourceLocation(), m_text, m_lines ),
+                     Range::of( node.identifier()->sourceLocation(), m_text, m_lines ),
+                     {} };
+        }
+
+        template < typename Definition >
+        void define( Definition& node, const char* detail, const i64 kind )
+        {
+            symbols.push_back( symbol( node, detail, kind ) );
+            fold( node );
+        }
+
+        template < typename Node >
+        void fold( Node& node )
+        {
+            // folding ranges are whole lines, the characters are not encoded
+            const auto& location = node.sourceLocation();
+            const auto startLine = static_cast< i64 >( location.begin.line ) - 1;
+            const auto endLine = static_cast< i64 >( location.end.line ) - 1;
+            if( endLine > startLine )
+            {
+                folds.emplace_back( startLine, endLine );
+            }
+        }
+
+      private:
+        const std::string& m_text;
+        const LineIndex& m_lines;
+        Symbol* m_enumeration = nullptr;
+    };
+}
+
+Outline::Outline( void )
+: m_symbols( "[]" )
+, m_foldingRanges( "[]" )
+{
+}
+
+Outline Outline::build(
+    const libpass::PassResult& analysis, const std::string& text, const LineIndex& lines )
+{
+    Outline outline;
+
+    if( not analysis.hasOutput< ConsistencyCheckPass >() )
+    {
+        return outline;
+    }
+
+    OutlineVisitor visitor( text, lines );
+    const auto& data = analysis.output< ConsistencyCheckPass >();
+    data->specification()->definitions()->accept( visitor );
+
+    outline.m_symbols.clear();
+    JsonWriter symbols( outline.m_symbols );
+    symbols.beginArray();
+    for( const auto& symbol : visitor.symbols )
+    {
+        symbol.serialize( symbols );
+    }
+    symbols.endArray();
+
+    // nested blocks starting on the same line fold as the outermost one
+    auto& folds = visitor.folds;
+    std::sort( folds.begin(), folds.end(), []( const std::pair< i64, i64 >& lhs,
+                                               const std::pair< i64, i64 >& rhs ) {
+        return lhs.first < rhs.first or ( lhs.first == rhs.first and lhs.second > rhs.second );
+    } );
+
+    outline.m_foldingRanges.clear();
+    JsonWriter foldingRanges( outline.m_foldingRanges );
+    foldingRanges.beginArray();
+    for( std::size_t index = 0; index < folds.size(); index++ )
+    {
+        if( index > 0 and folds[ index ].first == folds[ index - 1 ].first )
+        {
+            continue;
+        }
+
+        foldingRanges.beginObject();
+        foldingRanges.key( "startLine" ).number( folds[ index ].first );
+        foldingRanges.key( "endLine" ).number( folds[ index ].second );
+        foldingRanges.endObject();
+    }
+    foldingRanges.endArray();
+
+    return outline;
+}
+
+const std::string& Outline::symbols( void ) const
+{
+    return m_symbols;
+}
+
+const std::string& Outline::foldingRanges( void ) const
+{
+    return m_foldingRanges;
+}
+
+std::size_t Outline::usage( void ) const
+{
+    return m_symbols.capacity() + m_foldingRanges.capacity();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,89 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_OUTLINE_H_
+#define _CASMD_OUTLINE_H_
+
+/**
+   @brief    document symbols and folding ranges of a text document
+
+   Both are derived in one traversal of the AST of an analysis and kept in
+   their serialized form, therefore repeated outline and folding requests
+   of the same revision only copy the cached JSON into the response.
+*/
+
+#include "LineIndex.h"
+
+#include <libpass/PassResult>
+#include <libstdhl/Type>
+
+#include <string>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+
+    class Outline
+    {
+      public:
+        Outline( void );
+
+        /**
+           traverses the AST of the consistency check pass result of 'text',
+           'lines' is its line index, the characters of the symbol ranges
+           are UTF-16 code units
+        */
+        static Outline build(
+            const libpass::PassResult& analysis,
+            const std::string& text,
+            const LineIndex& lines );
+
+        /**
+           serialized 'DocumentSymbol[]'
+        */
+        const std::string& symbols( void ) const;
+
+        /**
+           serialized 'FoldingRange[]'
+        */
+        const std::string& foldingRanges( void ) const;
+
+        std::size_t usage( void ) const;
+
+      private:
+        std::string m_symbols;
+        std::string m_foldingRanges;
+    };
+}
+
+#endif  // _CASMD_OUTLINE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
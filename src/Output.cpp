@@ -0,0 +1,175 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Output.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <system_error>
+
+#if defined( _WIN32 )
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+using namespace casmd;
+
+Output::Output( void )
+: m_frames()
+, m_keys()
+, m_coalesced( 0 )
+{
+}
+
+void Output::push( const Frame& frame )
+{
+    if( not frame.key().empty() )
+    {
+        const auto result = m_keys.emplace( frame.key(), m_frames.size() );
+        if( not result.second )
+        {
+            m_frames[ result.first->second ] = frame;
+            m_coalesced++;
+            return;
+        }
+    }
+
+    m_frames.emplace_back( frame );
+}
+
+u1 Output::empty( void ) const
+{
+    return m_frames.empty();
+}
+
+std::size_t Output::size( void ) const
+{
+    return m_frames.size();
+}
+
+void Output::write( const int fd )
+{
+#if defined( _WIN32 )
+    write( [fd]( const std::string& buffer ) {
+        std::size_t offset = 0;
+        while( offset < buffer.size() )
+        {
+            const auto written = ::_write( fd, buffer.data() + offset, buffer.size() - offset );
+            if( written < 0 )
+            {
+                throw std::system_error( errno, std::generic_category(), "write" );
+            }
+            offset += written;
+        }
+    } );
+#else
+    std::vector< iovec > vector;
+    vector.reserve( m_frames.size() );
+    for( const auto& frame : m_frames )
+    {
+        vector.push_back( iovec{ const_cast< char* >( frame.data() ), frame.size() } );
+    }
+
+    std::size_t index = 0;
+    while( index < vector.size() )
+    {
+        const auto count = std::min< std::size_t >( vector.size() - index, IOV_MAX );
+        const auto written = ::writev( fd, &vector[ index ], static_cast< int >( count ) );
+        if( written < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            throw std::system_error( errno, std::generic_category(), "writev" );
+        }
+
+        // advance over completely written frames and resume partially written ones
+        auto remaining = static_cast< std::size_t >( written );
+        while( index < vector.size() and remaining >= vector[ index ].iov_len )
+        {
+            remaining -= vector[ index ].iov_len;
+            index++;
+        }
+        if( remaining > 0 )
+        {
+            vector[ index ].iov_base = static_cast< char* >( vector[ index ].iov_base ) + remaining;
+            vector[ index ].iov_len -= remaining;
+        }
+    }
+
+    clear();
+#endif
+}
+
+void Output::write( const std::function< void( const std::string& ) >& send )
+{
+    if( m_frames.empty() )
+    {
+        return;
+    }
+
+    std::size_t length = 0;
+    for( const auto& frame : m_frames )
+    {
+        length += frame.size();
+    }
+
+    std::string buffer;
+    buffer.reserve( length );
+    for( const auto& frame : m_frames )
+    {
+        buffer.append( frame.data(), frame.size() );
+    }
+
+    clear();
+    send( buffer );
+}
+
+std::size_t Output::coalesced( void ) const
+{
+    return m_coalesced;
+}
+
+void Output::clear( void )
+{
+    m_frames.clear();
+    m_keys.clear();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
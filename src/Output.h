@@ -0,0 +1,90 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_OUTPUT_H_
+#define _CASMD_OUTPUT_H_
+
+/**
+   @brief    output stage which batches the frames of a dispatch cycle
+
+   All frames pushed during one dispatch cycle are written at once, either
+   with a single vectored write to a file descriptor or a single send of a
+   session.  A pending frame is replaced if a frame with the same key is
+   pushed, so superseded diagnostics of a document never hit the wire.
+*/
+
+#include "Frame.h"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace casmd
+{
+    class Output
+    {
+      public:
+        Output( void );
+
+        /**
+           queues the frame, a pending frame with the same key is superseded
+        */
+        void push( const Frame& frame );
+
+        u1 empty( void ) const;
+
+        std::size_t size( void ) const;
+
+        /**
+           writes all pending frames to the file descriptor at once
+        */
+        void write( const int fd );
+
+        /**
+           passes all pending frames as one buffer to the send function
+        */
+        void write( const std::function< void( const std::string& ) >& send );
+
+        std::size_t coalesced( void ) const;
+
+      private:
+        void clear( void );
+
+      private:
+        std::vector< Frame > m_frames;
+        std::unordered_map< std::string, std::size_t > m_keys;
+        std::size_t m_coalesced;
+    };
+}
+
+#endif  // _CASMD_OUTPUT_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,68 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_PASS_LOCK_H_
+#define _CASMD_PASS_LOCK_H_
+
+/**
+   @brief    mutual exclusion of the libcasm-fe pass runs
+
+   The passes of libcasm-fe, libcasm-ir and libstdhl share process-wide
+   state, e.g. the caches of the IR types and constants and the registries of
+   the builtins and passes, which is not documented as thread-safe.  Every
+   run of a pass manager therefore holds the lock, whereas the work around it
+   (the flat machine, the formatting of the diagnostics, ...) runs
+   concurrently.  A handler which is called while the lock is held must not
+   run passes itself.
+*/
+
+#include <mutex>
+
+namespace casmd
+{
+    class PassLock
+    {
+      public:
+        PassLock( void );
+
+        PassLock( const PassLock& ) = delete;
+
+        PassLock& operator=( const PassLock& ) = delete;
+
+      private:
+        std::lock_guard< std::mutex > m_guard;
+    };
+}
+
+#endif  // _CASMD_PASS_LOCK_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,405 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Profile.h"
+
+#include "JsonWriter.h"
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libcasm-fe/ast/RecursiveVisitor>
+#include <libstdhl/Memory>
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+using namespace casmd;
+using namespace libcasm_fe;
+
+static std::string milliseconds( const u64 nanoseconds )
+{
+    char buffer[ 32 ];
+    std::snprintf( buffer, sizeof( buffer ), "%.2f ms", nanoseconds / 1e6 );
+    return buffer;
+}
+
+static std::string percent( const u64 part, const u64 whole )
+{
+    char buffer[ 16 ];
+    std::snprintf( buffer, sizeof( buffer ), "%.1f%%", whole > 0 ? 100.0 * part / whole : 0.0 );
+    return buffer;
+}
+
+namespace
+{
+    /**
+       transparent rule which reports the activations of the wrapped rule
+       body to the recorder, the visitor of the interpreter is forwarded
+    */
+    class ProfiledRule final : public Ast::Rule
+    {
+      public:
+        ProfiledRule(
+            const Ast::Rule::Ptr& rule, Profile::Recorder& recorder, const std::size_t index )
+        : Ast::Rule( rule->id() )
+        , m_rule( rule )
+        , m_recorder( recorder )
+        , m_index( index )
+        {
+            setSourceLocation( rule->sourceLocation() );
+        }
+
+        void accept( Ast::Visitor& visitor ) override
+        {
+            Activation activation( m_recorder, m_index );
+            m_rule->accept( visitor );
+        }
+
+      private:
+        /**
+           leaves the rule also if the interpreter aborts the step
+        */
+        struct Activation
+        {
+            Activation( Profile::Recorder& recorder, const std::size_t index )
+            : recorder( recorder )
+            {
+                recorder.enter( index );
+            }
+
+            ~Activation( void )
+            {
+                recorder.leave();
+            }
+
+            Profile::Recorder& recorder;
+        };
+
+        const Ast::Rule::Ptr m_rule;
+        Profile::Recorder& m_recorder;
+        const std::size_t m_index;
+    };
+
+    class InstrumentVisitor final : public Ast::RecursiveVisitor
+    {
+      public:
+        InstrumentVisitor( Profile::Recorder& recorder )
+        : m_recorder( recorder )
+        {
+        }
+
+        void visit( Ast::RuleDefinition& node ) override
+        {
+            // the body is not traversed, only definitions are instrumented
+            const auto index = m_recorder.define( node.identifier()->name() );
+            node.setRule(
+                libstdhl::Memory::make< ProfiledRule >( node.rule(), m_recorder, index ) );
+        }
+
+      private:
+        Profile::Recorder& m_recorder;
+    };
+
+    struct Lens
+    {
+        std::string name;
+        u32 line;
+        u32 startCharacter;
+        u32 endCharacter;
+    };
+
+    class LensVisitor final : public Ast::RecursiveVisitor
+    {
+      public:
+        LensVisitor( const std::string& text, const LineIndex& lines )
+        : m_text( text )
+        , m_lines( lines )
+        {
+        }
+
+        std::vector< Lens > lenses;
+
+        void visit( Ast::RuleDefinition& node ) override
+        {
+            // the AST reports byte columns
+            const auto& location = node.identifier()->sourceLocation();
+            const auto line = static_cast< u32 >( location.begin.line - 1 );
+            lenses.push_back(
+                { node.identifier()->name(),
+                  line,
+                  m_lines.character(
+                      m_text, line, static_cast< u32 >( location.begin.column - 1 ) ),
+                  m_lines.character(
+                      m_text, line, static_cast< u32 >( location.end.column - 1 ) ) } );
+        }
+
+      private:
+        const std::string& m_text;
+        const LineIndex& m_lines;
+    };
+}
+
+//
+//
+// Profile::Recorder
+//
+
+Profile::Recorder::Recorder( void )
+: m_rules()
+, m_depths()
+, m_stack()
+, m_duration( 0 )
+, m_steps( 0 )
+{
+}
+
+void Profile::Recorder::instrument( const libpass::PassResult& analysis )
+{
+    if( not analysis.hasOutput< ConsistencyCheckPass >() )
+    {
+        return;
+    }
+
+    InstrumentVisitor visitor( *this );
+    const auto& data = analysis.output< ConsistencyCheckPass >();
+    data->specification()->definitions()->accept( visitor );
+}
+
+std::size_t Profile::Recorder::define( const std::string& name )
+{
+    m_rules.push_back( { name, 0, 0, 0 } );
+    m_depths.push_back( 0 );
+    return m_rules.size() - 1;
+}
+
+void Profile::Recorder::enter( const std::size_t rule )
+{
+    if( m_stack.empty() )
+    {
+        m_steps++;
+    }
+
+    m_rules[ rule ].invocations++;
+    m_depths[ rule ]++;
+    m_stack.push_back( { rule, Clock::now(), 0 } );
+}
+
+void Profile::Recorder::leave( void )
+{
+    const auto activation = m_stack.back();
+    m_stack.pop_back();
+
+    const auto elapsed = static_cast< u64 >(
+        std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - activation.start )
+            .count() );
+
+    auto& rule = m_rules[ activation.rule ];
+    rule.selfTime += elapsed - std::min( elapsed, activation.children );
+
+    // recursive activations are part of the outermost one
+    m_depths[ activation.rule ]--;
+    if( m_depths[ activation.rule ] == 0 )
+    {
+        rule.time += elapsed;
+    }
+
+    if( m_stack.empty() )
+    {
+        m_duration += elapsed;
+    }
+    else
+    {
+        m_stack.back().children += elapsed;
+    }
+}
+
+u64 Profile::Recorder::steps( void ) const
+{
+    return m_steps;
+}
+
+Profile Profile::Recorder::profile( void ) const
+{
+    Profile profile;
+    profile.m_rules = m_rules;
+    profile.m_duration = m_duration;
+    return profile;
+}
+
+//
+//
+// Profile
+//
+
+Profile::Profile( void )
+: m_rules()
+, m_duration( 0 )
+, m_revision( -1 )
+{
+}
+
+u1 Profile::empty( void ) const
+{
+    return m_rules.empty();
+}
+
+const std::vector< Profile::Rule >& Profile::rules( void ) const
+{
+    return m_rules;
+}
+
+u64 Profile::duration( void ) const
+{
+    return m_duration;
+}
+
+i64 Profile::revision( void ) const
+{
+    return m_revision;
+}
+
+void Profile::setRevision( const i64 revision )
+{
+    m_revision = revision;
+}
+
+std::string Profile::report( void ) const
+{
+    auto rules = m_rules;
+    std::stable_sort( rules.begin(), rules.end(), []( const Rule& lhs, const Rule& rhs ) {
+        return lhs.selfTime > rhs.selfTime;
+    } );
+
+    std::string report = "";
+    for( const auto& rule : rules )
+    {
+        report += rule.name + ": " + std::to_string( rule.invocations ) + " calls, " +
+                  milliseconds( rule.time ) + " (" + percent( rule.time, m_duration ) +
+                  "), self " + milliseconds( rule.selfTime ) + " (" +
+                  percent( rule.selfTime, m_duration ) + ")\n";
+    }
+
+    report += "total: " + milliseconds( m_duration ) + " in " +
+              std::to_string( m_rules.size() ) + " rules\n";
+
+    return report;
+}
+
+std::string Profile::lenses(
+    const libpass::PassResult& analysis,
+    const std::string& text,
+    const LineIndex& lines,
+    const Profile& profile,
+    const i64 revision,
+    const std::string& uri )
+{
+    std::string lenses = "";
+    JsonWriter json( lenses );
+    json.beginArray();
+
+    if( analysis.hasOutput< ConsistencyCheckPass >() )
+    {
+        LensVisitor visitor( text, lines );
+        const auto& data = analysis.output< ConsistencyCheckPass >();
+        data->specification()->definitions()->accept( visitor );
+
+        std::unordered_map< std::string, const Rule* > rules;
+        for( const auto& rule : profile.rules() )
+        {
+            rules.emplace( rule.name, &rule );
+        }
+
+        const auto stale = not profile.empty() and profile.revision() != revision;
+
+        for( const auto& lens : visitor.lenses )
+        {
+            std::string title = "profile";
+            if( not profile.empty() )
+            {
+                const auto rule = rules.find( lens.name );
+                if( rule == rules.end() )
+                {
+                    title = "not profiled";
+                }
+                else if( rule->second->invocations == 0 )
+                {
+                    title = "not invoked";
+                }
+                else
+                {
+                    const auto& stats = *rule->second;
+                    title = std::to_string( stats.invocations ) + " calls, " +
+                            milliseconds( stats.time ) + " (" +
+                            percent( stats.time, profile.duration() ) + "), self " +
+                            milliseconds( stats.selfTime );
+                }
+
+                if( stale )
+                {
+                    title += " [revision " + std::to_string( profile.revision() ) + "]";
+                }
+            }
+
+            json.beginObject();
+            json.key( "range" ).beginObject();
+            json.key( "start" ).beginObject();
+            json.key( "line" ).number( lens.line );
+            json.key( "character" ).number( lens.startCharacter );
+            json.endObject();
+            json.key( "end" ).beginObject();
+            json.key( "line" ).number( lens.line );
+            json.key( "character" ).number( lens.endCharacter );
+            json.endObject();
+            json.endObject();
+            json.key( "command" ).beginObject();
+            json.key( "title" ).string( title );
+            json.key( "command" ).string( "profile", 7 );
+            json.key( "arguments" ).beginArray().string( uri ).endArray();
+            json.endObject();
+            json.endObject();
+        }
+    }
+
+    json.endArray();
+    return lenses;
+}
+
+std::size_t Profile::usage( void ) const
+{
+    std::size_t usage = m_rules.capacity() * sizeof( Rule );
+    for( const auto& rule : m_rules )
+    {
+        usage += rule.name.size();
+    }
+    return usage;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,177 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_PROFILE_H_
+#define _CASMD_PROFILE_H_
+
+/**
+   @brief    rule-level profile of a numeric execution
+
+   The recorder wraps the body of every rule definition of an analyzed
+   specification in a transparent node, therefore the interpreter reports
+   each rule activation without any change of the execution pass.  Per rule
+   the invocations, the inclusive time and the self time without called
+   rules are recorded, a recursive activation is only counted once in the
+   inclusive time.
+
+   The sizes of the update sets are not part of the profile, the wrapped
+   rule bodies do not see the update set of the interpreter and the
+   execution pass offers no other hook to observe it.
+*/
+
+#include "LineIndex.h"
+
+#include <libpass/PassResult>
+#include <libstdhl/Type>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using i64 = libstdhl::i64;
+    using u64 = libstdhl::u64;
+
+    class Profile
+    {
+      public:
+        struct Rule
+        {
+            std::string name;
+            u64 invocations;
+
+            /**
+               nanoseconds incl. the called rules
+            */
+            u64 time;
+
+            /**
+               nanoseconds without the called rules
+            */
+            u64 selfTime;
+        };
+
+        class Recorder
+        {
+          public:
+            Recorder( void );
+
+            /**
+               wraps the rule definitions of the consistency check pass
+               result, the recorder has to outlive the result
+            */
+            void instrument( const libpass::PassResult& analysis );
+
+            std::size_t define( const std::string& name );
+
+            void enter( const std::size_t rule );
+
+            void leave( void );
+
+            /**
+               amount of top-level rule activations, i.e. of steps
+            */
+            u64 steps( void ) const;
+
+            Profile profile( void ) const;
+
+          private:
+            using Clock = std::chrono::steady_clock;
+
+            struct Activation
+            {
+                std::size_t rule;
+                Clock::time_point start;
+                u64 children;
+            };
+
+          private:
+            std::vector< Rule > m_rules;
+            std::vector< std::size_t > m_depths;
+            std::vector< Activation > m_stack;
+            u64 m_duration;
+            u64 m_steps;
+        };
+
+        Profile( void );
+
+        u1 empty( void ) const;
+
+        /**
+           rules in order of their definition
+        */
+        const std::vector< Rule >& rules( void ) const;
+
+        /**
+           nanoseconds spent in top-level rule activations
+        */
+        u64 duration( void ) const;
+
+        /**
+           document revision the profile was recorded for
+        */
+        i64 revision( void ) const;
+
+        void setRevision( const i64 revision );
+
+        /**
+           textual report, rules ordered by their self time
+        */
+        std::string report( void ) const;
+
+        /**
+           serialized 'CodeLens[]' above every rule definition of the
+           analysis of 'text', 'lines' is its line index and the characters
+           are UTF-16 code units.  The profile is matched by rule name and
+           therefore still shown for later revisions of the document
+        */
+        static std::string lenses(
+            const libpass::PassResult& analysis,
+            const std::string& text,
+            const LineIndex& lines,
+            const Profile& profile,
+            const i64 revision,
+            const std::string& uri );
+
+        std::size_t usage( void ) const;
+
+      private:
+        std::vector< Rule > m_rules;
+        u64 m_duration;
+        i64 m_revision;
+    };
+}
+
+#endif  // _CASMD_PROFILE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
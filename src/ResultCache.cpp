@@ -0,0 +1,278 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "ResultCache.h"
+
+#include <libstdhl/String>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+using namespace casmd;
+
+static constexpr u64 FNV_OFFSET = 14695981039346656037ull;
+static constexpr u64 FNV_PRIME = 1099511628211ull;
+
+// first line of a persisted result, changes if the file format changes
+static constexpr const char* FILE_MAGIC = "casmd-result 3";
+
+static u64 hash( const std::string& text, u64 value = FNV_OFFSET )
+{
+    for( const auto c : text )
+    {
+        value = ( value ^ static_cast< unsigned char >( c ) ) * FNV_PRIME;
+    }
+    return value;
+}
+
+static std::string hex( const u64 value )
+{
+    char buffer[ 17 ];
+    const auto wide = static_cast< unsigned long long >( value );
+    std::snprintf( buffer, sizeof( buffer ), "%016llx", wide );
+    return buffer;
+}
+
+static std::size_t bytes( const std::string& key, const ResultCache::Result& result )
+{
+    return key.size() + result.source.size() + result.output.size() +
+           result.diagnostics.size() + result.fallback.size();
+}
+
+static u1 readField( std::istream& stream, std::string& field )
+{
+    std::size_t length = 0;
+    if( not( stream >> length ) or stream.get() != '\n' )
+    {
+        return false;
+    }
+
+    field.resize( length );
+    return static_cast< bool >( stream.read( &field[ 0 ], length ) );
+}
+
+ResultCache::ResultCache( const std::size_t budget, const std::size_t diskBudget )
+: m_entries()
+, m_index()
+, m_budget( budget )
+, m_diskBudget( diskBudget )
+, m_usage( 0 )
+, m_directory()
+, m_hits( 0 )
+, m_misses( 0 )
+{
+}
+
+void ResultCache::setDirectory( const std::string& directory )
+{
+    m_directory = directory;
+}
+
+const std::string& ResultCache::directory( void ) const
+{
+    return m_directory;
+}
+
+std::string ResultCache::key(
+    const std::string& content, const std::string& command, const std::string& arguments )
+{
+    // the separator keeps ('ab', 'c') and ('a', 'bc') apart
+    return hex( hash( content ) ) + "-" + hex( hash( arguments, hash( command + '\0' ) ) );
+}
+
+u1 ResultCache::find( const std::string& key, const std::string& source, Result& result )
+{
+    const auto entry = m_index.find( key );
+    if( entry != m_index.end() and entry->second->second.source == source )
+    {
+        m_entries.splice( m_entries.begin(), m_entries, entry->second );
+        result = entry->second->second;
+        m_hits++;
+        return true;
+    }
+
+    if( not m_directory.empty() )
+    {
+        std::ifstream stream( path( key ), std::ios::in | std::ios::binary );
+        std::string magic;
+        if( stream and std::getline( stream, magic ) and magic == FILE_MAGIC and
+            readField( stream, result.source ) and result.source == source and
+            readField( stream, result.output ) and readField( stream, result.diagnostics ) and
+            readField( stream, result.fallback ) )
+        {
+            // the modification time orders the files for the pruning
+            ::utime( path( key ).c_str(), nullptr );
+            remember( key, result );
+            m_hits++;
+            return true;
+        }
+    }
+
+    m_misses++;
+    return false;
+}
+
+void ResultCache::insert( const std::string& key, const Result& result )
+{
+    remember( key, result );
+
+    if( m_directory.empty() )
+    {
+        return;
+    }
+
+    // written to a temporary file first, readers never see a partial result
+    const auto target = path( key );
+    const auto temporary = target + ".tmp";
+    {
+        std::ofstream stream( temporary, std::ios::out | std::ios::binary | std::ios::trunc );
+        stream << FILE_MAGIC << "\n";
+        stream << result.source.size() << "\n" << result.source;
+        stream << result.output.size() << "\n" << result.output;
+        stream << result.diagnostics.size() << "\n" << result.diagnostics;
+        stream << result.fallback.size() << "\n" << result.fallback;
+        if( not stream )
+        {
+            std::remove( temporary.c_str() );
+            return;
+        }
+    }
+
+    std::rename( temporary.c_str(), target.c_str() );
+    prune( target );
+}
+
+u64 ResultCache::hits( void ) const
+{
+    return m_hits;
+}
+
+u64 ResultCache::misses( void ) const
+{
+    return m_misses;
+}
+
+std::size_t ResultCache::usage( void ) const
+{
+    return m_usage;
+}
+
+void ResultCache::remember( const std::string& key, const Result& result )
+{
+    const auto existing = m_index.find( key );
+    if( existing != m_index.end() )
+    {
+        m_usage -= bytes( key, existing->second->second );
+        m_entries.erase( existing->second );
+        m_index.erase( existing );
+    }
+
+    m_entries.emplace_front( key, result );
+    m_index[ key ] = m_entries.begin();
+    m_usage += bytes( key, result );
+
+    // the most-recently-used result is always kept
+    while( m_usage > m_budget and m_entries.size() > 1 )
+    {
+        const auto& last = m_entries.back();
+        m_usage -= bytes( last.first, last.second );
+        m_index.erase( last.first );
+        m_entries.pop_back();
+    }
+}
+
+std::string ResultCache::path( const std::string& key ) const
+{
+    return m_directory + "/" + key + ".result";
+}
+
+void ResultCache::prune( const std::string& written )
+{
+    auto handle = ::opendir( m_directory.c_str() );
+    if( not handle )
+    {
+        return;
+    }
+
+    // modification time, size and path of every result file
+    std::vector< std::tuple< time_t, std::size_t, std::string > > files;
+    std::size_t total = 0;
+
+    while( auto entry = ::readdir( handle ) )
+    {
+        const std::string name = entry->d_name;
+        if( not libstdhl::String::endsWith( name, ".result" ) )
+        {
+            continue;
+        }
+
+        const auto file = m_directory + "/" + name;
+        struct stat status;
+        if( ::stat( file.c_str(), &status ) != 0 or not S_ISREG( status.st_mode ) )
+        {
+            continue;
+        }
+
+        const auto size = static_cast< std::size_t >( status.st_size );
+        total += size;
+        if( file != written )
+        {
+            files.emplace_back( status.st_mtime, size, file );
+        }
+    }
+
+    ::closedir( handle );
+
+    if( total <= m_diskBudget )
+    {
+        return;
+    }
+
+    // the written file is always kept
+    std::sort( files.begin(), files.end() );
+    for( std::size_t index = 0; total > m_diskBudget and index < files.size(); index++ )
+    {
+        if( std::remove( std::get< 2 >( files[ index ] ).c_str() ) == 0 )
+        {
+            total -= std::get< 1 >( files[ index ] );
+        }
+    }
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
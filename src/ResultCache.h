@@ -0,0 +1,143 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_RESULT_CACHE_H_
+#define _CASMD_RESULT_CACHE_H_
+
+/**
+   @brief    memoized execution results of deterministic models
+
+   Results are keyed by the hash of the executed content together with the
+   command and its arguments.  Every result keeps the content it was keyed
+   by, a lookup with a different content is a miss, therefore a collision of
+   the hashes never serves the result of another model.  The cache keeps the most-recently-used
+   results in memory within a budget and, if a directory is configured,
+   persists every result in a file named by its key, therefore results
+   survive a restart of the server.  The persisted results are bounded by a
+   budget of their own, the least-recently-used files are removed first.
+*/
+
+#include <libstdhl/Type>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u64 = libstdhl::u64;
+
+    class ResultCache
+    {
+      public:
+        struct Result
+        {
+            /**
+               content passed to 'key', compared on a lookup
+            */
+            std::string source;
+
+            std::string output;
+
+            /**
+               serialized 'Diagnostic[]' of the execution
+            */
+            std::string diagnostics;
+
+            /**
+               why the flat backend fell back to the AST interpreter, or
+               empty
+            */
+            std::string fallback;
+        };
+
+        static constexpr std::size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+        static constexpr std::size_t DEFAULT_DISK_BUDGET = 256 * 1024 * 1024;
+
+        ResultCache(
+            const std::size_t budget = DEFAULT_BUDGET,
+            const std::size_t diskBudget = DEFAULT_DISK_BUDGET );
+
+        /**
+           enables the on-disk persistence in 'directory', an empty string
+           disables it
+        */
+        void setDirectory( const std::string& directory );
+
+        const std::string& directory( void ) const;
+
+        static std::string key(
+            const std::string& content, const std::string& command, const std::string& arguments );
+
+        /**
+           looks up the result of 'key' for 'source' in memory and on disk, a
+           result found on disk is kept in memory afterwards
+        */
+        u1 find( const std::string& key, const std::string& source, Result& result );
+
+        void insert( const std::string& key, const Result& result );
+
+        u64 hits( void ) const;
+
+        u64 misses( void ) const;
+
+        std::size_t usage( void ) const;
+
+      private:
+        using Entry = std::pair< std::string, Result >;
+
+        void remember( const std::string& key, const Result& result );
+
+        std::string path( const std::string& key ) const;
+
+        /**
+           removes the least-recently-used result files of the directory but
+           the 'written' one until they fit into the disk budget
+        */
+        void prune( const std::string& written );
+
+      private:
+        std::list< Entry > m_entries;
+        std::unordered_map< std::string, std::list< Entry >::iterator > m_index;
+        std::size_t m_budget;
+        std::size_t m_diskBudget;
+        std::size_t m_usage;
+        std::string m_directory;
+        u64 m_hits;
+        u64 m_misses;
+    };
+}
+
+#endif  // _CASMD_RESULT_CACHE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
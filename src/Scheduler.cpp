@@ -0,0 +1,407 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Scheduler.h"
+
+#include <libstdhl/String>
+
+#include <algorithm>
+
+using namespace casmd;
+using namespace libstdhl;
+using namespace Network;
+using namespace LSP;
+
+static std::string textDocumentUri( const Message& payload )
+{
+    if( payload.find( "params" ) == payload.end() )
+    {
+        return "";
+    }
+
+    const auto& params = payload[ "params" ];
+    if( params.find( "textDocument" ) == params.end() )
+    {
+        return "";
+    }
+
+    const auto& textDocument = params[ "textDocument" ];
+    if( textDocument.find( "uri" ) == textDocument.end() )
+    {
+        return "";
+    }
+
+    return textDocument[ "uri" ].get< std::string >();
+}
+
+/**
+   document of an execution command, the code lenses pass the profiled
+   document as argument whereas the other commands execute the in-memory model
+*/
+static std::string commandUri( const Message& payload )
+{
+    const auto& params = payload[ "params" ];
+    if( params[ "command" ].get< std::string >() == "profile" and
+        params.find( "arguments" ) != params.end() and params[ "arguments" ].size() > 0 and
+        params[ "arguments" ][ 0 ].is_string() )
+    {
+        return params[ "arguments" ][ 0 ].get< std::string >();
+    }
+
+    return "inmemory://model.casm";
+}
+
+/**
+   'true' if one of the content changes has no range, i.e. the text after the
+   change does not depend on the previous ones
+*/
+static u1 replacesText( const Message& payload )
+{
+    const auto& changes = payload[ "params" ][ "contentChanges" ];
+    for( std::size_t index = 0; index < changes.size(); index++ )
+    {
+        if( changes[ index ].find( "range" ) == changes[ index ].end() )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Scheduler::Request::Request( void )
+: header( 0 )
+, payload()
+, error()
+, priority( Priority::INTERACTIVE )
+, wait( 0 )
+{
+}
+
+Scheduler::Scheduler( void )
+: m_lock()
+, m_available()
+, m_queues()
+, m_statistics()
+, m_sequence( 0 )
+, m_closed( false )
+{
+    for( auto& statistics : m_statistics )
+    {
+        statistics = { 0, 0, 0, 0, {}, 0 };
+        statistics.waits.reserve( WAIT_SAMPLES );
+    }
+}
+
+Scheduler::Priority Scheduler::classify( const Message& payload )
+{
+    if( payload.find( "method" ) == payload.end() )
+    {
+        // responses of the client
+        return Priority::INTERACTIVE;
+    }
+
+    const std::string method = payload[ "method" ];
+    switch( String::value( method ) )
+    {
+        case String::value( "textDocument/didOpen" ):
+        case String::value( "textDocument/didChange" ):
+        case String::value( "textDocument/didClose" ):
+        case String::value( "textDocument/didSave" ):
+        {
+            return Priority::ANALYSIS;
+        }
+        case String::value( "workspace/executeCommand" ):
+        {
+            const auto& params = payload[ "params" ];
+            if( params.find( "command" ) == params.end() )
+            {
+                return Priority::INTERACTIVE;
+            }
+
+            const std::string command = params[ "command" ];
+            return command == "run" or command == "trace" or command == "profile" or
+                           command == "resume"
+                       ? Priority::BATCH
+                       : Priority::INTERACTIVE;
+        }
+        default:
+        {
+            return Priority::INTERACTIVE;
+        }
+    }
+}
+
+const char* Scheduler::name( const Priority priority )
+{
+    switch( priority )
+    {
+        case Priority::INTERACTIVE:
+        {
+            return "interactive";
+        }
+        case Priority::ANALYSIS:
+        {
+            return "analysis";
+        }
+        case Priority::BATCH:
+        {
+            return "batch";
+        }
+    }
+
+    return "unknown";
+}
+
+void Scheduler::push( Request request )
+{
+    request.priority = classify( request.payload );
+
+    // an execution is keyed by the document it executes, it waits for the
+    // queued changes of it and a later change waits until it started
+    const auto uri = request.priority != Priority::BATCH ? textDocumentUri( request.payload )
+                                                         : commandUri( request.payload );
+    const auto change =
+        request.priority == Priority::ANALYSIS and
+        request.payload[ "method" ].get< std::string >() == "textDocument/didChange";
+    const auto full = change and replacesText( request.payload );
+
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        const auto index = static_cast< std::size_t >( request.priority );
+        auto& queue = m_queues[ index ];
+
+        if( full and not uri.empty() )
+        {
+            // a full change supersedes the last queued change of the document
+            // unless the document was opened or closed in between
+            const auto last =
+                std::find_if( queue.rbegin(), queue.rend(), [&]( const Entry& entry ) {
+                    return entry.uri == uri;
+                } );
+            // a later request of the document must not observe the text of
+            // the superseding change
+            if( last != queue.rend() and last->change and latest( uri ) == last->sequence )
+            {
+                last->request = std::move( request );
+                m_statistics[ index ].coalesced++;
+                return;
+            }
+        }
+
+        queue.push_back( { std::move( request ), uri, change, Clock::now(), m_sequence++ } );
+    }
+
+    m_available.notify_one();
+}
+
+void Scheduler::reject( const std::string& error )
+{
+    Request request;
+    request.error = error;
+
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        m_queues[ 0 ].push_back(
+            { std::move( request ), "", false, Clock::now(), m_sequence++ } );
+    }
+
+    m_available.notify_one();
+}
+
+u1 Scheduler::pop( Request& request )
+{
+    std::unique_lock< std::mutex > guard( m_lock );
+
+    while( true )
+    {
+        // the oldest request of the lowest class is never held back, a
+        // request is taken as long as the queue is not empty
+        if( next( PRIORITIES, request ) )
+        {
+            return true;
+        }
+
+        if( m_closed )
+        {
+            return false;
+        }
+
+        m_available.wait( guard );
+    }
+}
+
+u1 Scheduler::poll( const Priority current, Request& request )
+{
+    std::lock_guard< std::mutex > guard( m_lock );
+
+    return next( static_cast< std::size_t >( current ), request );
+}
+
+u1 Scheduler::empty( void ) const
+{
+    std::lock_guard< std::mutex > guard( m_lock );
+
+    for( const auto& queue : m_queues )
+    {
+        if( not queue.empty() )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Scheduler::close( void )
+{
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        m_closed = true;
+    }
+
+    m_available.notify_all();
+}
+
+Scheduler::Metrics Scheduler::metrics( const Priority priority ) const
+{
+    std::lock_guard< std::mutex > guard( m_lock );
+
+    const auto index = static_cast< std::size_t >( priority );
+    const auto& statistics = m_statistics[ index ];
+
+    u64 p99 = 0;
+    if( not statistics.waits.empty() )
+    {
+        auto waits = statistics.waits;
+        const auto rank = ( waits.size() - 1 ) * 99 / 100;
+        std::nth_element( waits.begin(), waits.begin() + rank, waits.end() );
+        p99 = waits[ rank ];
+    }
+
+    return { statistics.requests,
+             statistics.coalesced,
+             statistics.totalWait,
+             statistics.maximumWait,
+             p99,
+             m_queues[ index ].size() };
+}
+
+u1 Scheduler::next( const std::size_t limit, Request& request )
+{
+    for( std::size_t priority = 0; priority < limit; priority++ )
+    {
+        auto& queue = m_queues[ priority ];
+        for( auto entry = queue.begin(); entry != queue.end(); ++entry )
+        {
+            if( not blocked( priority, *entry ) )
+            {
+                take( priority, entry, request );
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+u1 Scheduler::blocked( const std::size_t priority, const Entry& entry ) const
+{
+    if( entry.uri.empty() )
+    {
+        return false;
+    }
+
+    for( std::size_t lower = priority + 1; lower < PRIORITIES; lower++ )
+    {
+        // the queues are ordered by their sequence
+        for( const auto& pending : m_queues[ lower ] )
+        {
+            if( pending.sequence > entry.sequence )
+            {
+                break;
+            }
+            if( pending.uri == entry.uri )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+u64 Scheduler::latest( const std::string& uri ) const
+{
+    u64 sequence = 0;
+    for( const auto& queue : m_queues )
+    {
+        for( const auto& entry : queue )
+        {
+            if( entry.uri == uri )
+            {
+                sequence = std::max( sequence, entry.sequence );
+            }
+        }
+    }
+    return sequence;
+}
+
+void Scheduler::take(
+    const std::size_t priority, std::deque< Entry >::iterator entry, Request& request )
+{
+    auto& queue = m_queues[ priority ];
+
+    const auto wait = static_cast< u64 >( std::chrono::duration_cast< std::chrono::microseconds >(
+                                              Clock::now() - entry->enqueued )
+                                              .count() );
+
+    request = std::move( entry->request );
+    request.wait = wait;
+    queue.erase( entry );
+
+    auto& statistics = m_statistics[ priority ];
+    statistics.requests++;
+    statistics.totalWait += wait;
+    statistics.maximumWait = std::max( statistics.maximumWait, wait );
+
+    // ring of the recent wait times
+    if( statistics.waits.size() < WAIT_SAMPLES )
+    {
+        statistics.waits.push_back( wait );
+    }
+    else
+    {
+        statistics.waits[ statistics.next ] = wait;
+    }
+    statistics.next = ( statistics.next + 1 ) % WAIT_SAMPLES;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,212 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_SCHEDULER_H_
+#define _CASMD_SCHEDULER_H_
+
+/**
+   @brief    priority-aware dispatch queue of the language server
+
+   Requests are queued by the connection reader and taken by the dispatch
+   loop, always the oldest request of the highest class first.  Interactive
+   requests overtake queued analysis and execution requests, and work of a
+   lower class polls the queue at its pass boundaries to serve interactive
+   requests in between.  A queued change of a document is superseded by a
+   later change of the same document which carries its full text, whereas
+   incremental changes are queued in order.
+
+   Priorities only reorder requests of different documents.  A request of a
+   document never overtakes a text synchronization or an execution of the
+   same document which was queued before it, e.g. a hover waits for the
+   preceding change of its document instead of answering with the stale
+   text.  Executions are keyed by the document they execute, the in-memory
+   model or the profiled document.
+
+   The dispatch loop drains the queue between the passes of an execution,
+   never while a libcasm-fe pass runs, therefore a served request does not
+   re-enter the passes on the stack of a suspended one.
+*/
+
+#include <libstdhl/Type>
+#include <libstdhl/net/lsp/LSP>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u64 = libstdhl::u64;
+
+    class Scheduler
+    {
+      public:
+        enum class Priority
+        {
+            INTERACTIVE = 0,  // hover, completion, code actions and other queries
+            ANALYSIS = 1,     // text synchronization which triggers an analysis
+            BATCH = 2,        // executions, e.g. 'run' and 'trace'
+        };
+
+        static constexpr std::size_t PRIORITIES = 3;
+
+        struct Request
+        {
+            Request( void );
+
+            libstdhl::Network::LSP::Protocol header;
+            libstdhl::Network::LSP::Message payload;
+
+            /**
+               reason why the request could not be read, the payload is empty
+            */
+            std::string error;
+
+            Priority priority;
+
+            /**
+               time in microseconds the request waited in the queue
+            */
+            u64 wait;
+        };
+
+        struct Metrics
+        {
+            u64 requests;
+            u64 coalesced;
+            u64 totalWait;
+            u64 maximumWait;
+            u64 p99Wait;
+            std::size_t queued;
+        };
+
+        Scheduler( void );
+
+        static Priority classify( const libstdhl::Network::LSP::Message& payload );
+
+        static const char* name( const Priority priority );
+
+        /**
+           queues the request, thread-safe
+        */
+        void push( Request request );
+
+        /**
+           queues a request which could not be read, the dispatch loop
+           reports it in order
+        */
+        void reject( const std::string& error );
+
+        /**
+           blocks until a request is queued, returns 'false' if the queue is
+           closed and empty
+        */
+        u1 pop( Request& request );
+
+        /**
+           takes the oldest request of a class higher than 'current' without
+           blocking, returns 'false' if there is none or all of them wait for
+           a synchronization of their document
+        */
+        u1 poll( const Priority current, Request& request );
+
+        u1 empty( void ) const;
+
+        /**
+           wakes the dispatch loop after the reader reached the end of input
+        */
+        void close( void );
+
+        Metrics metrics( const Priority priority ) const;
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            Request request;
+            std::string uri;
+            u1 change;
+            Clock::time_point enqueued;
+            u64 sequence;
+        };
+
+        // amount of recent wait times kept per class for the percentile
+        static constexpr std::size_t WAIT_SAMPLES = 1024;
+
+        struct Statistics
+        {
+            u64 requests;
+            u64 coalesced;
+            u64 totalWait;
+            u64 maximumWait;
+            std::vector< u64 > waits;
+            std::size_t next;
+        };
+
+        /**
+           takes the oldest request of the classes below 'limit' which is
+           not held back by a synchronization of its document
+        */
+        u1 next( const std::size_t limit, Request& request );
+
+        /**
+           'true' if a lower class queues an earlier request of the document
+        */
+        u1 blocked( const std::size_t priority, const Entry& entry ) const;
+
+        /**
+           sequence of the latest queued request of the document
+        */
+        u64 latest( const std::string& uri ) const;
+
+        void take(
+            const std::size_t priority,
+            std::deque< Entry >::iterator entry,
+            Request& request );
+
+      private:
+        mutable std::mutex m_lock;
+        std::condition_variable m_available;
+        std::deque< Entry > m_queues[ PRIORITIES ];
+        Statistics m_statistics[ PRIORITIES ];
+        u64 m_sequence;
+        u1 m_closed;
+    };
+}
+
+#endif  // _CASMD_SCHEDULER_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
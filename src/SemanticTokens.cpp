@@ -0,0 +1,403 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "SemanticTokens.h"
+
+#include "Interface.h"
+
+#include <libcasm-fe/analyze/ConsistencyCheckPass>
+#include <libcasm-fe/ast/RecursiveVisitor>
+
+#include <algorithm>
+
+using namespace casmd;
+using namespace libcasm_fe;
+
+// amount of integers of one encoded token
+static constexpr std::size_t TOKEN_SIZE = 5;
+
+static inline u1 isIdentifierStart( const char c )
+{
+    return ( c >= 'a' and c <= 'z' ) or ( c >= 'A' and c <= 'Z' ) or c == '_';
+}
+
+static inline u1 isIdentifierPart( const char c )
+{
+    return isIdentifierStart( c ) or ( c >= '0' and c <= '9' );
+}
+
+namespace
+{
+    /**
+       classifies the identifiers of the definitions and call expressions
+    */
+    class TokenVisitor final : public Ast::RecursiveVisitor
+    {
+      public:
+        TokenVisitor( std::vector< SemanticTokens::Token >& tokens )
+        : m_tokens( tokens )
+        {
+        }
+
+        void visit( Ast::FunctionDefinition& node ) override
+        {
+            add( *node.identifier(), SemanticTokens::FUNCTION, SemanticTokens::DECLARATION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::DerivedDefinition& node ) override
+        {
+            add( *node.identifier(), SemanticTokens::DERIVED, SemanticTokens::DECLARATION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::RuleDefinition& node ) override
+        {
+            add( *node.identifier(), SemanticTokens::RULE, SemanticTokens::DECLARATION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::EnumerationDefinition& node ) override
+        {
+            add( *node.identifier(), SemanticTokens::ENUM, SemanticTokens::DECLARATION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::EnumeratorDefinition& node ) override
+        {
+            add( *node.identifier(), SemanticTokens::ENUM_MEMBER, SemanticTokens::DECLARATION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::VariableDefinition& node ) override
+        {
+            add( *node.identifier(), SemanticTokens::VARIABLE, SemanticTokens::DECLARATION );
+            RecursiveVisitor::visit( node );
+        }
+
+        void visit( Ast::DirectCallExpression& node ) override
+        {
+            switch( node.targetType() )
+            {
+                case Ast::DirectCallExpression::TargetType::FUNCTION:
+                {
+                    add( node, SemanticTokens::FUNCTION, SemanticTokens::NONE );
+                    break;
+                }
+                case Ast::DirectCallExpression::TargetType::DERIVED:
+                {
+                    add( node, SemanticTokens::DERIVED, SemanticTokens::NONE );
+                    break;
+                }
+                case Ast::DirectCallExpression::TargetType::RULE:
+                {
+                    add( node, SemanticTokens::RULE, SemanticTokens::NONE );
+                    break;
+                }
+                case Ast::DirectCallExpression::TargetType::BUILTIN:
+                {
+                    add( node, SemanticTokens::RULE, SemanticTokens::DEFAULT_LIBRARY );
+                    break;
+                }
+                case Ast::DirectCallExpression::TargetType::VARIABLE:
+                {
+                    add( node, SemanticTokens::VARIABLE, SemanticTokens::NONE );
+                    break;
+                }
+                case Ast::DirectCallExpression::TargetType::CONSTANT:
+                {
+                    add( node, SemanticTokens::ENUM_MEMBER, SemanticTokens::NONE );
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+
+            RecursiveVisitor::visit( node );
+        }
+
+      private:
+        void add(
+            const Ast::Identifier& identifier,
+            const SemanticTokens::Type type,
+            const u32 modifiers )
+        {
+            const auto& location = identifier.sourceLocation();
+            const auto length = identifier.name().size();
+            add( location.begin.line, location.begin.column, length, type, modifiers );
+        }
+
+        void add(
+            const Ast::DirectCallExpression& node,
+            const SemanticTokens::Type type,
+            const u32 modifiers )
+        {
+            // only the base name of a path like 'Color::Red' is classified
+            const auto& path = *node.identifier();
+            const auto& location = path.sourceLocation();
+            const auto length = path.baseName().size();
+            if( location.end.column < length + 1 )
+            {
+                return;
+            }
+
+            add( location.end.line, location.end.column - length, length, type, modifiers );
+        }
+
+        void add(
+            const std::size_t line,
+            const std::size_t column,
+            const std::size_t length,
+            const SemanticTokens::Type type,
+            const u32 modifiers )
+        {
+            if( line == 0 or column == 0 or length == 0 )
+            {
+                return;
+            }
+
+            m_tokens.push_back( { static_cast< u32 >( line - 1 ),
+                                  static_cast< u32 >( column - 1 ),
+                                  static_cast< u32 >( length ),
+                                  type,
+                                  modifiers } );
+        }
+
+      private:
+        std::vector< SemanticTokens::Token >& m_tokens;
+    };
+}
+
+std::vector< SemanticTokens::Token > SemanticTokens::collect(
+    const std::string& text, const LineIndex& lines, const libpass::PassResult& analysis )
+{
+    std::vector< Token > tokens;
+    scan( text, tokens );
+
+    if( analysis.hasOutput< ConsistencyCheckPass >() )
+    {
+        const auto& data = analysis.output< ConsistencyCheckPass >();
+        TokenVisitor visitor( tokens );
+        data->specification()->definitions()->accept( visitor );
+    }
+
+    std::stable_sort( tokens.begin(), tokens.end(), []( const Token& lhs, const Token& rhs ) {
+        return lhs.line < rhs.line or ( lhs.line == rhs.line and lhs.character < rhs.character );
+    } );
+
+    // LSP tokens must not overlap, the first token of a position wins
+    std::size_t count = 0;
+    for( std::size_t index = 0; index < tokens.size(); index++ )
+    {
+        if( count > 0 )
+        {
+            const auto& last = tokens[ count - 1 ];
+            if( last.line == tokens[ index ].line and
+                last.character + last.length > tokens[ index ].character )
+            {
+                continue;
+            }
+        }
+        tokens[ count++ ] = tokens[ index ];
+    }
+    tokens.resize( count );
+
+    // the scan and the AST report byte columns
+    for( auto& token : tokens )
+    {
+        const auto start = lines.character( text, token.line, token.character );
+        token.length =
+            lines.character( text, token.line, token.character + token.length ) - start;
+        token.character = start;
+    }
+
+    return tokens;
+}
+
+void SemanticTokens::scan( const std::string& text, std::vector< Token >& tokens )
+{
+    const auto size = text.size();
+    u32 line = 0;
+    std::size_t lineStart = 0;
+    std::size_t position = 0;
+
+    while( position < size )
+    {
+        const auto c = text[ position ];
+
+        if( c == '\n' )
+        {
+            position++;
+            line++;
+            lineStart = position;
+        }
+        else if( c == '/' and position + 1 < size and text[ position + 1 ] == '/' )
+        {
+            while( position < size and text[ position ] != '\n' )
+            {
+                position++;
+            }
+        }
+        else if( c == '/' and position + 1 < size and text[ position + 1 ] == '*' )
+        {
+            position += 2;
+            while( position < size and
+                   not( text[ position ] == '*' and position + 1 < size and
+                        text[ position + 1 ] == '/' ) )
+            {
+                if( text[ position ] == '\n' )
+                {
+                    line++;
+                    lineStart = position + 1;
+                }
+                position++;
+            }
+            position = std::min( position + 2, size );
+        }
+        else if( c == '"' )
+        {
+            position++;
+            while( position < size and text[ position ] != '"' and text[ position ] != '\n' )
+            {
+                position += ( text[ position ] == '\\' ) ? 2 : 1;
+            }
+            position = std::min( position + 1, size );
+        }
+        else if( isIdentifierStart( c ) )
+        {
+            const auto start = position;
+            while( position < size and isIdentifierPart( text[ position ] ) )
+            {
+                position++;
+            }
+
+            const auto length = position - start;
+            if( Interface::keyword( text.data() + start, length ) )
+            {
+                tokens.push_back( { line,
+                                    static_cast< u32 >( start - lineStart ),
+                                    static_cast< u32 >( length ),
+                                    KEYWORD,
+                                    NONE } );
+            }
+        }
+        else if( c >= '0' and c <= '9' )
+        {
+            // skips numbers incl. suffixes like '0x1f' or '1.5e3'
+            while( position < size and isIdentifierPart( text[ position ] ) )
+            {
+                position++;
+            }
+        }
+        else
+        {
+            position++;
+        }
+    }
+}
+
+std::vector< u32 > SemanticTokens::encode( const std::vector< Token >& tokens )
+{
+    std::vector< u32 > data;
+    data.reserve( tokens.size() * TOKEN_SIZE );
+
+    u32 line = 0;
+    u32 character = 0;
+
+    for( const auto& token : tokens )
+    {
+        const auto deltaLine = token.line - line;
+        data.push_back( deltaLine );
+        data.push_back( deltaLine == 0 ? token.character - character : token.character );
+        data.push_back( token.length );
+        data.push_back( token.type );
+        data.push_back( token.modifiers );
+
+        line = token.line;
+        character = token.character;
+    }
+
+    return data;
+}
+
+u1 SemanticTokens::delta(
+    const std::vector< u32 >& previous, const std::vector< u32 >& current, Edit& edit )
+{
+    const auto limit = std::min( previous.size(), current.size() );
+
+    std::size_t prefix = 0;
+    while( prefix < limit and previous[ prefix ] == current[ prefix ] )
+    {
+        prefix++;
+    }
+    prefix -= prefix % TOKEN_SIZE;
+
+    if( prefix == previous.size() and prefix == current.size() )
+    {
+        return false;
+    }
+
+    std::size_t suffix = 0;
+    while( suffix < limit - prefix and
+           previous[ previous.size() - 1 - suffix ] == current[ current.size() - 1 - suffix ] )
+    {
+        suffix++;
+    }
+    suffix -= suffix % TOKEN_SIZE;
+
+    edit.start = static_cast< u32 >( prefix );
+    edit.deleteCount = static_cast< u32 >( previous.size() - prefix - suffix );
+    edit.data.assign( current.begin() + prefix, current.end() - suffix );
+    return true;
+}
+
+void SemanticTokens::legend( JsonWriter& json )
+{
+    json.beginObject();
+    json.key( "tokenTypes" ).beginArray();
+    json.string( "keyword", 7 );
+    json.string( "function", 8 );
+    json.string( "variable", 8 );
+    json.string( "property", 8 );
+    json.string( "enum", 4 );
+    json.string( "enumMember", 10 );
+    json.string( "parameter", 9 );
+    json.endArray();
+    json.key( "tokenModifiers" ).beginArray();
+    json.string( "declaration", 11 );
+    json.string( "defaultLibrary", 14 );
+    json.endArray();
+    json.endObject();
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
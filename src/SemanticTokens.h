@@ -0,0 +1,140 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_SEMANTIC_TOKENS_H_
+#define _CASMD_SEMANTIC_TOKENS_H_
+
+/**
+   @brief    semantic tokens of a text document
+
+   Keywords are found by a lexical scan of the text with the keyword table
+   of 'Interface', whereas the symbols (rules, functions, derived,
+   enumerations, locals and builtins) are classified by the AST of the
+   cached analysis.  The tokens are encoded
+   in the relative integer format of the LSP and a changed encoding is
+   reduced to a single edit of the differing token run.
+*/
+
+#include "JsonWriter.h"
+#include "LineIndex.h"
+
+#include <libpass/PassResult>
+#include <libstdhl/Type>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u32 = libstdhl::u32;
+
+    class SemanticTokens
+    {
+      public:
+        /**
+           token types, the values are the indices of the legend.  The LSP
+           has no types for the ASM notions, a rule is a 'function', a
+           function is a 'variable' of the state, a derived is a 'property'
+           computed from the state, and the immutable bindings of let,
+           forall and rule parameters are 'parameter's.  Builtins are
+           'function's of the default library like rules
+        */
+        enum Type : u32
+        {
+            KEYWORD = 0,
+            RULE = 1,
+            FUNCTION = 2,
+            DERIVED = 3,
+            ENUM = 4,
+            ENUM_MEMBER = 5,
+            VARIABLE = 6,
+        };
+
+        /**
+           token modifiers, the values are the bits of the legend indices
+        */
+        enum Modifier : u32
+        {
+            NONE = 0,
+            DECLARATION = 1 << 0,
+            DEFAULT_LIBRARY = 1 << 1,
+        };
+
+        struct Token
+        {
+            u32 line;
+            u32 character;
+            u32 length;
+            Type type;
+            u32 modifiers;
+        };
+
+        struct Edit
+        {
+            u32 start;
+            u32 deleteCount;
+            std::vector< u32 > data;
+        };
+
+        /**
+           collects the sorted tokens of 'text', 'analysis' is the pass result
+           of the consistency check of the same text and 'lines' its line
+           index, the characters and lengths are UTF-16 code units
+        */
+        static std::vector< Token > collect(
+            const std::string& text,
+            const LineIndex& lines,
+            const libpass::PassResult& analysis );
+
+        /**
+           collects the keyword tokens of 'text'
+        */
+        static void scan( const std::string& text, std::vector< Token >& tokens );
+
+        static std::vector< u32 > encode( const std::vector< Token >& tokens );
+
+        /**
+           computes the edit which transforms 'previous' into 'current',
+           returns 'false' if both encodings are equal
+        */
+        static u1 delta(
+            const std::vector< u32 >& previous, const std::vector< u32 >& current, Edit& edit );
+
+        /**
+           serializes the 'SemanticTokensLegend' of the server capabilities
+        */
+        static void legend( JsonWriter& json );
+    };
+}
+
+#endif  // _CASMD_SEMANTIC_TOKENS_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
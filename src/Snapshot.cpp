@@ -0,0 +1,295 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using namespace casmd;
+
+// first bytes of a snapshot file, changes if the encoding changes
+static constexpr const char FILE_MAGIC[] = "casmd-snapshot 1\n";
+static constexpr std::size_t FILE_MAGIC_SIZE = sizeof( FILE_MAGIC ) - 1;
+
+static void writeNumber( std::string& data, u64 value )
+{
+    while( value >= 0x80 )
+    {
+        data += static_cast< char >( ( value & 0x7f ) | 0x80 );
+        value >>= 7;
+    }
+    data += static_cast< char >( value );
+}
+
+static void writeInteger( std::string& data, const i64 value )
+{
+    // zig-zag encoding keeps small negative values short
+    const auto bits = static_cast< u64 >( value );
+    writeNumber( data, ( bits << 1 ) ^ ( value < 0 ? ~u64( 0 ) : 0 ) );
+}
+
+static u1 readNumber( const std::string& data, std::size_t& position, u64& value )
+{
+    value = 0;
+    for( u32 shift = 0; shift < 64; shift += 7 )
+    {
+        if( position >= data.size() )
+        {
+            return false;
+        }
+
+        const auto byte = static_cast< unsigned char >( data[ position++ ] );
+        value |= static_cast< u64 >( byte & 0x7f ) << shift;
+        if( ( byte & 0x80 ) == 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static u1 readInteger( const std::string& data, std::size_t& position, i64& value )
+{
+    u64 bits = 0;
+    if( not readNumber( data, position, bits ) )
+    {
+        return false;
+    }
+    value = static_cast< i64 >( ( bits >> 1 ) ^ ( ~( bits & 1 ) + 1 ) );
+    return true;
+}
+
+static u1 readText( const std::string& data, std::size_t& position, std::string& text )
+{
+    u64 size = 0;
+    if( not readNumber( data, position, size ) or size > data.size() - position )
+    {
+        return false;
+    }
+    text.assign( data, position, size );
+    position += size;
+    return true;
+}
+
+Snapshot::Snapshot( void )
+: m_step( 0 )
+, m_fingerprint( 0 )
+, m_data()
+{
+}
+
+Snapshot::Snapshot( State state )
+: m_step( state.step )
+, m_fingerprint( 0 )
+, m_data()
+{
+    writeNumber( m_data, state.step );
+    writeInteger( m_data, state.rule );
+    writeNumber( m_data, state.output.size() );
+    m_data += state.output;
+    writeNumber( m_data, state.tables.size() );
+
+    for( auto& table : state.tables )
+    {
+        auto& entries = table.entries;
+        std::sort( entries.begin(), entries.end(), []( const Entry& lhs, const Entry& rhs ) {
+            return lhs.first < rhs.first or ( lhs.first == rhs.first and lhs.second < rhs.second );
+        } );
+
+        writeNumber( m_data, table.arity );
+        writeNumber( m_data, entries.size() );
+
+        // the first argument is delta-encoded, dense tables take a byte
+        i64 previous = 0;
+        for( const auto& entry : entries )
+        {
+            writeInteger(
+                m_data,
+                static_cast< i64 >(
+                    static_cast< u64 >( entry.first ) - static_cast< u64 >( previous ) ) );
+            previous = entry.first;
+            if( table.arity > 1 )
+            {
+                writeInteger( m_data, entry.second );
+            }
+            writeNumber( m_data, entry.kind );
+            writeInteger( m_data, entry.data );
+        }
+    }
+}
+
+u1 Snapshot::decode( State& state ) const
+{
+    std::size_t position = 0;
+    u64 tables = 0;
+    if( not( readNumber( m_data, position, state.step ) and
+             readInteger( m_data, position, state.rule ) and
+             readText( m_data, position, state.output ) and
+             readNumber( m_data, position, tables ) ) or
+        tables > m_data.size() )
+    {
+        return false;
+    }
+
+    state.tables.assign( tables, Table{ 0, {} } );
+    for( auto& table : state.tables )
+    {
+        u64 arity = 0;
+        u64 count = 0;
+        if( not( readNumber( m_data, position, arity ) and
+                 readNumber( m_data, position, count ) ) or
+            count > m_data.size() - position )
+        {
+            return false;
+        }
+        table.arity = static_cast< u32 >( arity );
+        table.entries.resize( count );
+
+        i64 previous = 0;
+        for( auto& entry : table.entries )
+        {
+            i64 delta = 0;
+            u64 kind = 0;
+            entry.second = 0;
+            if( not( readInteger( m_data, position, delta ) and
+                     ( arity <= 1 or readInteger( m_data, position, entry.second ) ) and
+                     readNumber( m_data, position, kind ) and
+                     readInteger( m_data, position, entry.data ) ) )
+            {
+                return false;
+            }
+            entry.first = static_cast< i64 >(
+                static_cast< u64 >( previous ) + static_cast< u64 >( delta ) );
+            entry.kind = static_cast< u8 >( kind );
+            previous = entry.first;
+        }
+    }
+
+    return position == m_data.size();
+}
+
+u64 Snapshot::step( void ) const
+{
+    return m_step;
+}
+
+u64 Snapshot::fingerprint( void ) const
+{
+    return m_fingerprint;
+}
+
+void Snapshot::setFingerprint( const u64 fingerprint )
+{
+    m_fingerprint = fingerprint;
+}
+
+std::size_t Snapshot::size( void ) const
+{
+    return m_data.size();
+}
+
+std::string Snapshot::describe( void ) const
+{
+    State state;
+    if( not decode( state ) )
+    {
+        return "malformed snapshot";
+    }
+
+    std::size_t locations = 0;
+    for( const auto& table : state.tables )
+    {
+        locations += table.entries.size();
+    }
+
+    return "step " + std::to_string( state.step ) + ", " +
+           std::to_string( state.tables.size() ) + " functions, " +
+           std::to_string( locations ) + " locations, " + std::to_string( m_data.size() ) +
+           " bytes";
+}
+
+u1 Snapshot::save( const std::string& path ) const
+{
+    // a crash while writing leaves the previous file intact
+    const auto temporary = path + ".tmp";
+    {
+        std::ofstream stream( temporary, std::ios::out | std::ios::binary | std::ios::trunc );
+        std::string header( FILE_MAGIC, FILE_MAGIC_SIZE );
+        writeNumber( header, m_fingerprint );
+        stream << header << m_data;
+        if( not stream )
+        {
+            std::remove( temporary.c_str() );
+            return false;
+        }
+    }
+    return std::rename( temporary.c_str(), path.c_str() ) == 0;
+}
+
+u1 Snapshot::load( const std::string& path, Snapshot& snapshot )
+{
+    std::ifstream stream( path, std::ios::in | std::ios::binary );
+    if( not stream )
+    {
+        return false;
+    }
+
+    const std::string data(
+        ( std::istreambuf_iterator< char >( stream ) ), std::istreambuf_iterator< char >() );
+    if( data.compare( 0, FILE_MAGIC_SIZE, FILE_MAGIC ) != 0 )
+    {
+        return false;
+    }
+
+    std::size_t position = FILE_MAGIC_SIZE;
+    Snapshot loaded;
+    if( not readNumber( data, position, loaded.m_fingerprint ) )
+    {
+        return false;
+    }
+    loaded.m_data = data.substr( position );
+
+    State state;
+    if( not loaded.decode( state ) )
+    {
+        return false;
+    }
+    loaded.m_step = state.step;
+
+    snapshot = std::move( loaded );
+    return true;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,136 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef _CASMD_SNAPSHOT_H_
+#define _CASMD_SNAPSHOT_H_
+
+/**
+   @brief    serialized state of a numeric execution at a step boundary
+
+   A snapshot holds the function tables, the step counter, the current rule
+   of the agent and the output of the executed steps of the flat backend
+   (see 'Machine').  The state is encoded in a compact byte string of
+   variable-length integers, locations of a table are ordered by their
+   arguments and delta-encoded, therefore the encoding is deterministic.
+   A snapshot can be written to a file, loaded again after a restart of the
+   server and inspected without a specification.
+*/
+
+#include <libstdhl/Type>
+
+#include <string>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+    using u8 = libstdhl::u8;
+    using u32 = libstdhl::u32;
+    using i64 = libstdhl::i64;
+    using u64 = libstdhl::u64;
+
+    class Snapshot
+    {
+      public:
+        struct Entry
+        {
+            i64 first;
+            i64 second;
+            i64 data;
+            u8 kind;
+        };
+
+        /**
+           locations of a function, a nullary function has exactly one
+        */
+        struct Table
+        {
+            u32 arity;
+            std::vector< Entry > entries;
+        };
+
+        struct State
+        {
+            u64 step;
+            i64 rule;
+            std::string output;
+            std::vector< Table > tables;
+        };
+
+        Snapshot( void );
+
+        /**
+           encodes 'state', the entries of the tables are sorted
+        */
+        explicit Snapshot( State state );
+
+        /**
+           returns 'false' if the data is truncated or malformed
+        */
+        u1 decode( State& state ) const;
+
+        u64 step( void ) const;
+
+        /**
+           behavior fingerprint of the executed content, see 'Interface'
+        */
+        u64 fingerprint( void ) const;
+
+        void setFingerprint( const u64 fingerprint );
+
+        /**
+           bytes of the encoded state
+        */
+        std::size_t size( void ) const;
+
+        /**
+           one-line summary of the encoded state
+        */
+        std::string describe( void ) const;
+
+        u1 save( const std::string& path ) const;
+
+        /**
+           returns 'false' if the file is missing or not a snapshot
+        */
+        static u1 load( const std::string& path, Snapshot& snapshot );
+
+      private:
+        u64 m_step;
+        u64 m_fingerprint;
+        std::string m_data;
+    };
+}
+
+#endif  // _CASMD_SNAPSHOT_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,214 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "ThreadPool.h"
+
+#include <cassert>
+
+using namespace casmd;
+
+// pool and deque index of the current worker thread
+static thread_local ThreadPool* s_pool = nullptr;
+static thread_local std::size_t s_index = 0;
+
+ThreadPool::ThreadPool( const std::size_t workers )
+: m_queues()
+, m_threads()
+, m_lock()
+, m_available()
+, m_finished()
+, m_queued( 0 )
+, m_pending( 0 )
+, m_next( 0 )
+, m_error()
+, m_stop( false )
+{
+    const auto count = workers > 0 ? workers : concurrency();
+
+    for( std::size_t index = 0; index < count; index++ )
+    {
+        m_queues.emplace_back( new Queue );
+    }
+
+    for( std::size_t index = 0; index < count; index++ )
+    {
+        m_threads.emplace_back( &ThreadPool::work, this, index );
+    }
+}
+
+ThreadPool::~ThreadPool( void )
+{
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        m_stop = true;
+    }
+    m_available.notify_all();
+
+    for( auto& thread : m_threads )
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit( Task task )
+{
+    m_pending++;
+
+    const auto index = s_pool == this ? s_index : ( m_next++ % m_queues.size() );
+    {
+        auto& queue = *m_queues[ index ];
+        std::lock_guard< std::mutex > guard( queue.lock );
+        queue.tasks.emplace_back( std::move( task ) );
+    }
+
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        m_queued++;
+    }
+    m_available.notify_one();
+}
+
+void ThreadPool::wait( void )
+{
+    assert( s_pool != this and "a worker waits for its own task" );
+
+    std::unique_lock< std::mutex > guard( m_lock );
+    m_finished.wait( guard, [&]() { return m_pending == 0; } );
+
+    if( m_error )
+    {
+        const auto error = m_error;
+        m_error = nullptr;
+        guard.unlock();
+        std::rethrow_exception( error );
+    }
+}
+
+std::size_t ThreadPool::workers( void ) const
+{
+    return m_threads.size();
+}
+
+std::size_t ThreadPool::concurrency( void )
+{
+    const auto count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void ThreadPool::work( const std::size_t index )
+{
+    s_pool = this;
+    s_index = index;
+
+    while( true )
+    {
+        if( process( index ) )
+        {
+            continue;
+        }
+
+        std::unique_lock< std::mutex > guard( m_lock );
+        m_available.wait( guard, [&]() { return m_stop or m_queued > 0; } );
+        if( m_stop and m_queued == 0 )
+        {
+            return;
+        }
+    }
+}
+
+u1 ThreadPool::process( const std::size_t index )
+{
+    Task task;
+    u1 found = false;
+
+    // own tasks are taken newest first, tasks of other workers are stolen oldest first
+    for( std::size_t offset = 0; offset < m_queues.size() and not found; offset++ )
+    {
+        auto& queue = *m_queues[ ( index + offset ) % m_queues.size() ];
+        std::lock_guard< std::mutex > guard( queue.lock );
+        if( queue.tasks.empty() )
+        {
+            continue;
+        }
+
+        if( offset == 0 )
+        {
+            task = std::move( queue.tasks.back() );
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move( queue.tasks.front() );
+            queue.tasks.pop_front();
+        }
+        found = true;
+    }
+
+    if( not found )
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        m_queued--;
+    }
+
+    // a throwing task still finishes, otherwise 'wait' blocks forever
+    std::exception_ptr error;
+    try
+    {
+        task();
+    }
+    catch( ... )
+    {
+        error = std::current_exception();
+    }
+
+    if( error )
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        if( not m_error )
+        {
+            m_error = error;
+        }
+    }
+
+    if( --m_pending == 0 )
+    {
+        std::lock_guard< std::mutex > guard( m_lock );
+        m_finished.notify_all();
+    }
+
+    return true;
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
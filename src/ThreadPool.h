@@ -0,0 +1,124 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_THREAD_POOL_H_
+#define _CASMD_THREAD_POOL_H_
+
+/**
+   @brief    work-stealing thread pool
+
+   Every worker owns a task deque.  Tasks submitted from outside the pool are
+   distributed round-robin, tasks submitted by a worker are pushed to its own
+   deque.  A worker takes its newest task first and steals the oldest task of
+   another worker if its own deque is empty.
+*/
+
+#include <libstdhl/Type>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace casmd
+{
+    using u1 = libstdhl::u1;
+
+    class ThreadPool
+    {
+      public:
+        using Task = std::function< void( void ) >;
+
+        /**
+           creates a pool with 'workers' threads, zero selects the amount of
+           hardware threads
+        */
+        ThreadPool( const std::size_t workers = 0 );
+
+        ~ThreadPool( void );
+
+        ThreadPool( const ThreadPool& ) = delete;
+
+        ThreadPool& operator=( const ThreadPool& ) = delete;
+
+        /**
+           queues 'task', an exception of the task is caught by the worker
+           and rethrown by the next 'wait'
+        */
+        void submit( Task task );
+
+        /**
+           blocks until all submitted tasks are finished and rethrows the
+           first exception of a task since the last wait, the others are
+           dropped.  The waiting thread does not process tasks, and the task
+           of a worker is only finished after it returns, therefore it must
+           not be called by a worker of the pool
+        */
+        void wait( void );
+
+        std::size_t workers( void ) const;
+
+        static std::size_t concurrency( void );
+
+      private:
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque< Task > tasks;
+        };
+
+        void work( const std::size_t index );
+
+        u1 process( const std::size_t index );
+
+      private:
+        std::vector< std::unique_ptr< Queue > > m_queues;
+        std::vector< std::thread > m_threads;
+
+        std::mutex m_lock;
+        std::condition_variable m_available;
+        std::condition_variable m_finished;
+        std::size_t m_queued;
+        std::atomic< std::size_t > m_pending;
+        std::atomic< std::size_t > m_next;
+        std::exception_ptr m_error;
+        u1 m_stop;
+    };
+}
+
+#endif  // _CASMD_THREAD_POOL_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,163 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Workspace.h"
+
+#include <iterator>
+
+using namespace casmd;
+using namespace libstdhl;
+using namespace Network;
+using namespace LSP;
+
+Workspace::Workspace( const std::size_t budget )
+: m_budget( budget )
+, m_evictions( 0 )
+, m_documents()
+, m_index()
+{
+}
+
+Document& Workspace::open(
+    const DocumentUri& uri,
+    const std::string& languageId,
+    const std::string& text,
+    const i64 revision )
+{
+    const auto result = m_index.find( uri.toString() );
+    if( result != m_index.end() )
+    {
+        auto document = result->second;
+        document->setText( text, revision );
+        document->setOpen( true );
+        touch( document );
+        return *document;
+    }
+
+    m_documents.emplace_front( uri, languageId, text, revision );
+    m_index.emplace( uri.toString(), m_documents.begin() );
+    return m_documents.front();
+}
+
+u1 Workspace::close( const DocumentUri& uri )
+{
+    const auto result = m_index.find( uri.toString() );
+    if( result == m_index.end() )
+    {
+        return false;
+    }
+
+    result->second->setOpen( false );
+    return true;
+}
+
+Document* Workspace::find( const DocumentUri& uri )
+{
+    const auto result = m_index.find( uri.toString() );
+    if( result == m_index.end() )
+    {
+        return nullptr;
+    }
+
+    touch( result->second );
+    return &( *result->second );
+}
+
+void Workspace::enforce( void )
+{
+    if( m_documents.empty() )
+    {
+        return;
+    }
+
+    auto total = usage();
+
+    // the most-recently-used document is the active one and is never evicted,
+    // all other documents are visited from the least-recently-used one onwards
+    auto document = std::prev( m_documents.end() );
+    while( total > m_budget and document != m_documents.begin() )
+    {
+        const auto previous = std::prev( document );
+
+        if( not document->isOpen() )
+        {
+            total -= document->usage();
+            m_index.erase( document->uri().toString() );
+            m_documents.erase( document );
+            m_evictions++;
+        }
+        else if( document->artifactUsage() > 0 )
+        {
+            total -= document->artifactUsage();
+            document->evict();
+            m_evictions++;
+        }
+
+        document = previous;
+    }
+}
+
+std::size_t Workspace::budget( void ) const
+{
+    return m_budget;
+}
+
+void Workspace::setBudget( const std::size_t budget )
+{
+    m_budget = budget;
+}
+
+std::size_t Workspace::usage( void ) const
+{
+    std::size_t total = 0;
+    for( const auto& document : m_documents )
+    {
+        total += document.usage();
+    }
+    return total;
+}
+
+std::size_t Workspace::evictions( void ) const
+{
+    return m_evictions;
+}
+
+const std::list< Document >& Workspace::documents( void ) const
+{
+    return m_documents;
+}
+
+void Workspace::touch( std::list< Document >::iterator document )
+{
+    m_documents.splice( m_documents.begin(), m_documents, document );
+}
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -0,0 +1,113 @@
+//
+//  Copyright (C) 2017-2024 CASM Organization <https://casm-lang.org>
+//  All rights reserved.
+//
+//  Developed by: Philipp Paulweber et al.
+//  <https://github.com/casm-lang/casmd/graphs/contributors>
+//
+//  This file is part of casmd.
+//
+//  casmd is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  casmd is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with casmd. If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef _CASMD_WORKSPACE_H_
+#define _CASMD_WORKSPACE_H_
+
+/**
+   @brief    documents of a language server session within a memory budget
+
+   The workspace keeps its documents in least-recently-used (LRU) order.
+   Whenever the memory usage of all documents exceeds the budget, the
+   artifacts of the least-recently-used documents are evicted and closed
+   documents are dropped entirely.  The text of open documents and the
+   artifacts of the most-recently-used document are never evicted.
+*/
+
+#include "Document.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace casmd
+{
+    class Workspace
+    {
+      public:
+        static constexpr std::size_t DEFAULT_BUDGET = 512 * 1024 * 1024;
+
+        Workspace( const std::size_t budget = DEFAULT_BUDGET );
+
+        /**
+           opens a new document or re-opens a previously closed document
+           with the provided text
+        */
+        Document& open(
+            const libstdhl::Network::LSP::DocumentUri& uri,
+            const std::string& languageId,
+            const std::string& text,
+            const i64 revision );
+
+        /**
+           marks the document as closed, its text and artifacts are kept
+           until the budget requires an eviction
+        */
+        u1 close( const libstdhl::Network::LSP::DocumentUri& uri );
+
+        /**
+           returns the document of the given URI and marks it as most-recently-used,
+           or 'nullptr' if there is no such document
+        */
+        Document* find( const libstdhl::Network::LSP::DocumentUri& uri );
+
+        /**
+           evicts artifacts and closed documents in LRU order until the usage
+           fits into the budget again
+        */
+        void enforce( void );
+
+        std::size_t budget( void ) const;
+
+        void setBudget( const std::size_t budget );
+
+        std::size_t usage( void ) const;
+
+        std::size_t evictions( void ) const;
+
+        /**
+           documents in LRU order, the most-recently-used document comes first
+        */
+        const std::list< Document >& documents( void ) const;
+
+      private:
+        void touch( std::list< Document >::iterator document );
+
+      private:
+        std::size_t m_budget;
+        std::size_t m_evictions;
+        std::list< Document > m_documents;
+        std::unordered_map< std::string, std::list< Document >::iterator > m_index;
+    };
+}
+
+#endif  // _CASMD_WORKSPACE_H_
+
+//
+//  Local variables:
+//  mode: c++
+//  indent-tabs-mode: nil
+//  c-basic-offset: 4
+//  tab-width: 4
+//  End:
+//  vim:noexpandtab:sw=4:ts=4:
+//
@@ -21,7 +21,11 @@
 //  along with casmd. If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "Batch.h"
+#include "FlightRecorder.h"
 #include "LanguageServer.h"
+#include "Output.h"
+#include "Scheduler.h"
 #include "casmd/Version"
 
 #include <libpass/PassManager>
@@ -30,6 +34,10 @@
 #include <libstdhl/String>
 #include <libstdhl/net/tcp/IPv4>
 
+#include <cstdio>
+#include <functional>
+#include <thread>
+
 /**
     @brief TODO
 
@@ -38,11 +46,61 @@
 
 static constexpr const char* MODE = "mode";
 static constexpr const char* MODE_LSP = "lsp";
+static constexpr const char* MODE_CHECK = "check";
+static constexpr const char* MODE_RUN = "run";
+static constexpr const char* MODE_FLIGHT = "flight";
+
+static constexpr const char* FILES = "files";
+static constexpr const char* JOBS = "jobs";
+static constexpr const char* FORMAT = "format";
+static constexpr const char* FORMAT_HUMAN = "human";
+static constexpr const char* FORMAT_JSON = "json";
+static constexpr const char* BACKEND = "backend";
+static constexpr const char* BACKEND_AST = "ast";
+static constexpr const char* BACKEND_FLAT = "flat";
+static constexpr const char* BACKEND_PARALLEL = "parallel";
 
 static constexpr const char* CONN = "connection";
 static constexpr const char* CONN_TCP4 = "tcp4";
 static constexpr const char* CONN_STDIO = "stdio";
 
+static constexpr const char* MEMORY_BUDGET = "memory-budget";
+static constexpr const char* CACHE_DIRECTORY = "cache-directory";
+static constexpr const char* FLIGHT_RECORDER = "flight-recorder";
+
+// maximum amount of pending frames before the output is written
+static constexpr std::size_t OUTPUT_BATCH = 256;
+static constexpr int STDOUT_DESCRIPTOR = 1;
+
+static std::size_t parseBytes( const std::string& text )
+{
+    std::size_t pos = 0;
+    const auto value = std::stoull( text, &pos );
+    const auto unit = text.substr( pos );
+
+    switch( String::value( unit ) )
+    {
+        case String::value( "" ):
+        {
+            return value;
+        }
+        case String::value( "K" ):
+        {
+            return value * 1024;
+        }
+        case String::value( "M" ):
+        {
+            return value * 1024 * 1024;
+        }
+        case String::value( "G" ):
+        {
+            return value * 1024 * 1024 * 1024;
+        }
+    }
+
+    throw std::invalid_argument( "invalid byte unit '" + unit + "'" );
+}
+
 int main( int argc, const char* argv[] )
 {
     libpass::PassManager pm;
@@ -59,7 +117,15 @@ int main( int argc, const char* argv[] )
     std::unordered_map< std::string, std::vector< std::string > > setting;
 
     libstdhl::Args options( argc, argv, libstdhl::Args::DEFAULT, [&]( const char* arg ) {
-        if( strcmp( arg, MODE_LSP ) == 0 )
+        if( setting[ MODE ].size() > 0 and
+            ( setting[ MODE ].front() == MODE_CHECK or setting[ MODE ].front() == MODE_RUN or
+              setting[ MODE ].front() == MODE_FLIGHT ) )
+        {
+            setting[ FILES ].emplace_back( arg );
+        }
+        else if(
+            strcmp( arg, MODE_LSP ) == 0 or strcmp( arg, MODE_CHECK ) == 0 or
+            strcmp( arg, MODE_RUN ) == 0 or strcmp( arg, MODE_FLIGHT ) == 0 )
         {
             if( setting[ MODE ].size() > 0 )
             {
@@ -97,7 +163,11 @@ int main( int argc, const char* argv[] )
             log.output(
                 "\n" + std::string( casmd::DESCRIPTION ) + "\n" + log.source()->name() +
                 ": usage: [options] mode\n" + "\n" + "mode: \n" +
-                "  lsp                            language server protocol\n" + "\n" +
+                "  lsp                            language server protocol\n" +
+                "  check <path>...                check specification files and directories\n" +
+                "  run <path>...                  execute specification files and directories\n" +
+                "  flight <file>...               decode flight recorder files\n" +
+                "\n" +
                 "options: \n" + options.usage() + "\n" );
 
             return -1;
@@ -134,6 +204,99 @@ int main( int argc, const char* argv[] )
             return 0;
         } );
 
+    options.add(
+        MEMORY_BUDGET,
+        libstdhl::Args::REQUIRED,
+        "memory budget of cached document artifacts (e.g. 512M)",
+        [&]( const char* arg ) {
+            try
+            {
+                parseBytes( arg );
+            }
+            catch( const std::exception& e )
+            {
+                log.error( "invalid memory budget '" + std::string( arg ) + "'" );
+                return 1;
+            }
+
+            setting[ MEMORY_BUDGET ].emplace_back( arg );
+            return 0;
+        },
+        "bytes" );
+
+    options.add(
+        CACHE_DIRECTORY,
+        libstdhl::Args::REQUIRED,
+        "persist the results of deterministic model executions in a directory",
+        [&]( const char* arg ) {
+            setting[ CACHE_DIRECTORY ].emplace_back( arg );
+            return 0;
+        },
+        "path" );
+
+    options.add(
+        FLIGHT_RECORDER,
+        libstdhl::Args::REQUIRED,
+        "keep the flight recorder of the language server in a file (default: temporary)",
+        [&]( const char* arg ) {
+            setting[ FLIGHT_RECORDER ].emplace_back( arg );
+            return 0;
+        },
+        "path" );
+
+    options.add(
+        JOBS,
+        libstdhl::Args::REQUIRED,
+        "amount of worker threads (default: all cores)",
+        [&]( const char* arg ) {
+            try
+            {
+                std::stoul( arg );
+            }
+            catch( const std::exception& e )
+            {
+                log.error( "invalid amount of jobs '" + std::string( arg ) + "'" );
+                return 1;
+            }
+
+            setting[ JOBS ].emplace_back( arg );
+            return 0;
+        },
+        "number" );
+
+    options.add(
+        FORMAT,
+        libstdhl::Args::REQUIRED,
+        "output format of the batch modes, 'human' (default) or 'json' lines",
+        [&]( const char* arg ) {
+            if( strcmp( arg, FORMAT_HUMAN ) != 0 and strcmp( arg, FORMAT_JSON ) != 0 )
+            {
+                log.error( "invalid format '" + std::string( arg ) + "'" );
+                return 1;
+            }
+
+            setting[ FORMAT ].emplace_back( arg );
+            return 0;
+        },
+        "format" );
+
+    options.add(
+        BACKEND,
+        libstdhl::Args::REQUIRED,
+        "execution backend of the run mode, 'ast' (default), 'flat' or 'parallel'",
+        [&]( const char* arg ) {
+            if( strcmp( arg, BACKEND_AST ) != 0 and strcmp( arg, BACKEND_FLAT ) != 0 and
+                strcmp( arg, BACKEND_PARALLEL ) != 0 )
+            {
+                log.error( "invalid backend '" + std::string( arg ) + "'" );
+                return 1;
+            }
+
+            setting[ BACKEND ].emplace_back( arg );
+            return 0;
+        },
+        "backend" );
+
     if( auto ret = options.parse( log ) )
     {
         flush();
@@ -162,24 +325,129 @@ int main( int argc, const char* argv[] )
         return 2;
     }
 
+    const auto& mode = setting[ MODE ].front();
+
     if( setting[ CONN ].size() == 0 )
     {
-        log.info( "no connection provided, using '--stdio'" );
-        flush();
+        if( mode == MODE_LSP )
+        {
+            log.info( "no connection provided, using '--stdio'" );
+            flush();
+        }
         setting[ CONN ].emplace_back( CONN_STDIO );
     }
 
-    const auto& mode = setting[ MODE ].front();
     const auto& conn = setting[ CONN ].front();
     const auto& kind = setting[ conn ].front();
     const auto prefix = mode + "@" + conn + ": ";
+    const auto budget = setting[ MEMORY_BUDGET ].size() > 0
+                            ? parseBytes( setting[ MEMORY_BUDGET ].back() )
+                            : casmd::Workspace::DEFAULT_BUDGET;
+    const std::size_t jobs = setting[ JOBS ].size() > 0 ? std::stoul( setting[ JOBS ].back() ) : 0;
 
     switch( String::value( mode ) )
     {
         case String::value( MODE_LSP ):
         {
             // language server protocol mode
-            casmd::LanguageServer server( log );
+            casmd::LanguageServer server( log, budget, jobs );
+            if( setting[ CACHE_DIRECTORY ].size() > 0 )
+            {
+                server.setCacheDirectory( setting[ CACHE_DIRECTORY ].back() );
+            }
+
+            // the recent frames and passes are always recorded, a temporary
+            // recording is removed after a regular shutdown
+            casmd::FlightRecorder recorder;
+            const auto temporary = setting[ FLIGHT_RECORDER ].size() == 0;
+            try
+            {
+                recorder.open(
+                    temporary ? casmd::FlightRecorder::temporary()
+                              : setting[ FLIGHT_RECORDER ].back() );
+                log.info( "flight recorder in '" + recorder.path() + "'" );
+            }
+            catch( const std::exception& e )
+            {
+                log.warning( e.what() );
+            }
+            flush();
+
+            casmd::Scheduler scheduler;
+            casmd::Output output;
+
+            const auto handle = [&]( const casmd::Scheduler::Request& request ) {
+                if( not request.error.empty() )
+                {
+                    casmd::FlightRecorder::record(
+                        casmd::FlightRecorder::Kind::NOTE, request.error );
+                    log.error( request.error );
+                    flush();
+                    return;
+                }
+
+                libstdhl::Network::LSP::Packet packet( request.header, request.payload );
+                log.info(
+                    prefix + "REQ: " + packet.dump( true ) + "\n" +
+                    casmd::Scheduler::name( request.priority ) + " request waited " +
+                    std::to_string( request.wait ) + " us\n" );
+                flush();
+
+                casmd::FlightRecorder::Span span(
+                    "dispatch", casmd::Scheduler::name( request.priority ) );
+                try
+                {
+                    if( not server.dispatch( request.payload ) )
+                    {
+                        packet.process( server );
+                    }
+                }
+                catch( const std::exception& e )
+                {
+                    log.error( e.what() );
+                }
+
+                server.drain( [&]( const casmd::Frame& response ) {
+                    log.info( prefix + "ACK: " + response.payload() + "\n" );
+                    flush();
+                    casmd::FlightRecorder::record(
+                        casmd::FlightRecorder::Kind::OUTBOUND, response.payload() );
+                    output.push( response );
+                } );
+            };
+
+            // the connection is read by its own thread into the dispatch
+            // queue, requests are processed by priority on this thread
+            const auto serve = [&]( const std::function< void( void ) >& read,
+                                    const std::function< void( void ) >& write ) {
+                server.schedule( scheduler, [&]( const casmd::Scheduler::Request& request ) {
+                    // interactive requests served at a pass boundary are
+                    // answered immediately
+                    handle( request );
+                    write();
+                } );
+
+                std::thread reader( [&]( void ) {
+                    read();
+                    scheduler.close();
+                } );
+
+                casmd::Scheduler::Request request;
+                while( scheduler.pop( request ) )
+                {
+                    handle( request );
+
+                    // queued requests belong to the same dispatch cycle, the
+                    // pending frames are written before the queue runs empty
+                    if( scheduler.empty() or output.size() >= OUTPUT_BATCH )
+                    {
+                        write();
+                    }
+                }
+
+                write();
+                reader.join();
+            };
 
             switch( String::value( conn ) )
             {
@@ -194,29 +462,33 @@ int main( int argc, const char* argv[] )
                     log.info( "starting new TCP::IPv4 session" );
                     flush();
 
-                    while( true )
-                    {
-                        const auto message = session.receive();
-                        const auto request = libstdhl::Network::LSP::Packet::parse( message );
-                        log.info( prefix + "REQ: " + request.dump( true ) + "\n" );
-                        flush();
-
-                        try
-                        {
-                            request.process( server );
-                        }
-                        catch( const std::exception& e )
+                    const auto read = [&]( void ) {
+                        while( true )
                         {
-                            log.error( e.what() );
+                            casmd::Scheduler::Request request;
+                            try
+                            {
+                                const auto message = session.receive();
+                                casmd::FlightRecorder::record(
+                                    casmd::FlightRecorder::Kind::INBOUND, message );
+                                const auto packet =
+                                    libstdhl::Network::LSP::Packet::parse( message );
+                                request.header = packet.header();
+                                request.payload = packet.payload();
+                            }
+                            catch( const std::exception& e )
+                            {
+                                scheduler.reject( e.what() );
+                                return;
+                            }
+                            scheduler.push( std::move( request ) );
                         }
+                    };
 
-                        server.flush( [&]( const libstdhl::Network::LSP::Message& response ) {
-                            log.info( prefix + "ACK: " + response.dump( true ) + "\n" );
-                            flush();
-                            const auto packet = libstdhl::Network::LSP::Packet( response );
-                            session.send( packet.dump() );
-                        } );
-                    }
+                    serve( read, [&]( void ) {
+                        output.write(
+                            [&]( const std::string& frames ) { session.send( frames ); } );
+                    } );
 
                     session.disconnect();
                     iface.disconnect();
@@ -228,80 +500,65 @@ int main( int argc, const char* argv[] )
                     log.info( "starting new STDIO session" );
                     flush();
 
-                    std::string buffer;
-                    buffer.reserve( 4096 );
-                    while( true )
-                    {
-                        buffer = "";
+                    const auto read = [&]( void ) {
+                        std::string buffer;
+                        buffer.reserve( 4096 );
                         while( true )
                         {
-                            std::string tmp;
-                            std::getline( std::cin, tmp );
-                            buffer += tmp + "\n";
-                            if( String::endsWith( buffer, "\r\n\r\n" ) )
+                            buffer = "";
+                            while( true )
                             {
-                                break;
+                                std::string tmp;
+                                if( not std::getline( std::cin, tmp ) )
+                                {
+                                    return;
+                                }
+                                buffer += tmp + "\n";
+                                if( String::endsWith( buffer, "\r\n\r\n" ) )
+                                {
+                                    break;
+                                }
                             }
-                        }
-
-                        libstdhl::Network::LSP::Protocol header( 0 );
-                        libstdhl::Network::LSP::Message payload;
 
-                        log.info( prefix + "REQ: HEADER: " + buffer + "\n" );
-                        flush();
-                        try
-                        {
-                            header = libstdhl::Network::LSP::Protocol::parse( buffer );
-                        }
-                        catch( const std::exception& e )
-                        {
-                            log.error( e.what() );
-                            flush();
-                            continue;
-                        }
-
-                        const auto length = header.length();
-                        if( buffer.length() < length )
-                        {
-                            buffer.resize( length );
-                        }
-                        std::cin.read( &buffer[ 0 ], length );
-                        buffer[ length ] = '\0';
-
-                        log.info( prefix + "REQ: CONTENT: " + buffer + "\n" );
-                        flush();
-
-                        try
-                        {
-                            payload = libstdhl::Network::LSP::Message::parse( buffer );
-                        }
-                        catch( const std::exception& e )
-                        {
-                            log.error( e.what() );
-                            flush();
-                            continue;
-                        }
+                            casmd::Scheduler::Request request;
+                            try
+                            {
+                                request.header = libstdhl::Network::LSP::Protocol::parse( buffer );
+                            }
+                            catch( const std::exception& e )
+                            {
+                                scheduler.reject( "invalid header '" + buffer + "': " + e.what() );
+                                continue;
+                            }
 
-                        libstdhl::Network::LSP::Packet request( header, payload );
-                        log.info( prefix + "REQ: " + request.dump( true ) + "\n" );
-                        flush();
+                            const auto length = request.header.length();
+                            if( buffer.length() < length )
+                            {
+                                buffer.resize( length );
+                            }
+                            if( not std::cin.read( &buffer[ 0 ], length ) )
+                            {
+                                return;
+                            }
+                            buffer[ length ] = '\0';
+                            casmd::FlightRecorder::record(
+                                casmd::FlightRecorder::Kind::INBOUND, buffer.data(), length );
 
-                        try
-                        {
-                            request.process( server );
-                        }
-                        catch( const std::exception& e )
-                        {
-                            log.error( e.what() );
+                            try
+                            {
+                                request.payload =
+                                    libstdhl::Network::LSP::Message::parse( buffer );
+                            }
+                            catch( const std::exception& e )
+                            {
+                                scheduler.reject( "invalid content '" + buffer + "': " + e.what() );
+                                continue;
+                            }
+                            scheduler.push( std::move( request ) );
                         }
+                    };
 
-                        server.flush( [&]( const libstdhl::Network::LSP::Message& response ) {
-                            const auto packet = libstdhl::Network::LSP::Packet( response );
-                            std::cout << packet.dump() << std::flush;
-                            log.info( prefix + "ACK: " + packet.dump( true ) + "\n" );
-                            flush();
-                        } );
-                    }
+                    serve( read, [&]( void ) { output.write( STDOUT_DESCRIPTOR ); } );
                     break;
                 }
                 default:
@@ -311,8 +568,87 @@ int main( int argc, const char* argv[] )
                     return -1;
                 }
             }
+
+            const auto path = recorder.path();
+            recorder.close();
+            if( temporary and not path.empty() )
+            {
+                std::remove( path.c_str() );
+            }
             break;
         }
+        case String::value( MODE_CHECK ):
+        case String::value( MODE_RUN ):
+        {
+            // batch consistency check and execution mode
+            if( setting[ FILES ].size() == 0 )
+            {
+                log.error(
+                    "no files provided to " + mode + ", please see --help for more information" );
+                flush();
+                return 2;
+            }
+
+            const auto format = ( setting[ FORMAT ].size() > 0 and
+                                  setting[ FORMAT ].back() == FORMAT_JSON )
+                                    ? casmd::Batch::Format::JSON
+                                    : casmd::Batch::Format::HUMAN;
+
+            try
+            {
+                casmd::Batch batch( setting[ FILES ], jobs, format );
+                const auto backend =
+                    setting[ BACKEND ].size() > 0 ? setting[ BACKEND ].back() : BACKEND_AST;
+                if( backend == BACKEND_FLAT )
+                {
+                    batch.setBackend( casmd::Execution::Backend::FLAT );
+                }
+                else if( backend == BACKEND_PARALLEL )
+                {
+                    batch.setBackend( casmd::Execution::Backend::PARALLEL );
+                }
+                const auto result =
+                    mode == MODE_RUN ? batch.run( std::cout ) : batch.check( std::cout );
+                flush();
+                return result;
+            }
+            catch( const std::exception& e )
+            {
+                log.error( e.what() );
+                flush();
+                return 2;
+            }
+        }
+        case String::value( MODE_FLIGHT ):
+        {
+            // offline decoder of the flight recorder files of crashed or
+            // slow sessions
+            if( setting[ FILES ].size() == 0 )
+            {
+                log.error(
+                    "no files provided to " + mode + ", please see --help for more information" );
+                flush();
+                return 2;
+            }
+
+            try
+            {
+                for( const auto& file : setting[ FILES ] )
+                {
+                    std::cout << file << ":\n";
+                    casmd::FlightRecorder::decode( file, std::cout );
+                }
+            }
+            catch( const std::exception& e )
+            {
+                log.error( e.what() );
+                flush();
+                return 2;
+            }
+
+            flush();
+            return 0;
+        }
         default:
         {
             log.error( "unimplemented mode '" + mode + "' selected, aborting" );